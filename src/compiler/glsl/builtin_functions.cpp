@@ -7725,7 +7725,14 @@ builtin_builder::_helper_invocation()
 
 /******************************************************************************/
 
-/* The singleton instance of builtin_builder. */
+/* The singleton instance of builtin_builder.
+ *
+ * builtins_lock only protects creation and destruction of the built-in
+ * shader.  Once created, the shader is never modified, and everything that
+ * looks up built-ins holds a reference (see ensure_builtin_types() in
+ * shaderapi.c), so lookups don't need to take the lock.  This matters with
+ * several threads compiling shaders at the same time.
+ */
 static builtin_builder builtins;
 static mtx_t builtins_lock = _MTX_INITIALIZER_NP;
 static uint32_t builtin_users = 0;
@@ -7757,32 +7764,21 @@ ir_function_signature *
 _mesa_glsl_find_builtin_function(_mesa_glsl_parse_state *state,
                                  const char *name, exec_list *actual_parameters)
 {
-   ir_function_signature *s;
-   mtx_lock(&builtins_lock);
-   s = builtins.find(state, name, actual_parameters);
-   mtx_unlock(&builtins_lock);
-
-   return s;
+   return builtins.find(state, name, actual_parameters);
 }
 
 bool
 _mesa_glsl_has_builtin_function(_mesa_glsl_parse_state *state, const char *name)
 {
-   ir_function *f;
-   bool ret = false;
-   mtx_lock(&builtins_lock);
-   f = builtins.shader->symbols->get_function(name);
+   ir_function *f = builtins.shader->symbols->get_function(name);
    if (f != NULL) {
       foreach_in_list(ir_function_signature, sig, &f->signatures) {
-         if (sig->is_builtin_available(state)) {
-            ret = true;
-            break;
-         }
+         if (sig->is_builtin_available(state))
+            return true;
       }
    }
-   mtx_unlock(&builtins_lock);
 
-   return ret;
+   return false;
 }
 
 gl_shader *
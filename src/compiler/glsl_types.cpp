@@ -26,6 +26,7 @@
 #include "compiler/glsl/glsl_parser_extras.h"
 #include "glsl_types.h"
 #include "util/hash_table.h"
+#include "util/u_atomic.h"
 #include "util/u_string.h"
 
 
@@ -43,6 +44,30 @@ hash_table *glsl_type::subroutine_types = NULL;
  */
 static uint32_t glsl_type_users = 0;
 
+/* Bumped every time the type tables are destroyed, so that entries in the
+ * per-thread array type caches which point at freed types are never hit.
+ * Starts at 1 so that zero-initialized cache entries are invalid.
+ */
+static uint32_t glsl_type_generation = 1;
+
+/* Array types are looked up constantly by glsl_to_nir, spirv_to_nir and
+ * NIR lowering passes, often from several compiler threads at once.  A small
+ * direct-mapped per-thread cache in front of array_types lets repeated
+ * lookups of the same array type skip hash_mutex and the key formatting.
+ */
+struct array_type_cache_entry {
+   const glsl_type *base;
+   unsigned array_size;
+   unsigned explicit_stride;
+   uint32_t generation;
+   const glsl_type *type;
+};
+
+#define ARRAY_TYPE_CACHE_SIZE 64
+
+static thread_local array_type_cache_entry
+   array_type_cache[ARRAY_TYPE_CACHE_SIZE];
+
 glsl_type::glsl_type(GLenum gl_type,
                      glsl_base_type base_type, unsigned vector_elements,
                      unsigned matrix_columns, const char *name,
@@ -564,6 +589,8 @@ glsl_type_singleton_decref()
       glsl_type::subroutine_types = NULL;
    }
 
+   p_atomic_inc(&glsl_type_generation);
+
    mtx_unlock(&glsl_type::hash_mutex);
 }
 
@@ -1113,6 +1140,21 @@ glsl_type::get_array_instance(const glsl_type *base,
                               unsigned array_size,
                               unsigned explicit_stride)
 {
+   /* The caller holds a reference on the type singleton, so the generation
+    * can't change while we are using it.
+    */
+   const uint32_t generation = p_atomic_read(&glsl_type_generation);
+   array_type_cache_entry *cached =
+      &array_type_cache[((uintptr_t) base / sizeof(glsl_type) +
+                         array_size * 7 + explicit_stride) %
+                        ARRAY_TYPE_CACHE_SIZE];
+
+   if (cached->generation == generation &&
+       cached->base == base &&
+       cached->array_size == array_size &&
+       cached->explicit_stride == explicit_stride)
+      return cached->type;
+
    /* Generate a name using the base type pointer in the key.  This is
     * done because the name of the base type may not be unique across
     * shaders.  For example, two shaders may have different record types
@@ -1147,6 +1189,12 @@ glsl_type::get_array_instance(const glsl_type *base,
 
    mtx_unlock(&glsl_type::hash_mutex);
 
+   cached->base = base;
+   cached->array_size = array_size;
+   cached->explicit_stride = explicit_stride;
+   cached->generation = generation;
+   cached->type = t;
+
    return t;
 }
 
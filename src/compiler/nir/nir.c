@@ -482,6 +482,8 @@ instr_init(nir_instr *instr, nir_instr_type type)
 {
    instr->type = type;
    instr->block = NULL;
+   instr->pass_flags = 0;
+   instr->index = 0;
    exec_node_init(&instr->node);
 }
 
@@ -515,13 +517,18 @@ nir_alu_instr *
 nir_alu_instr_create(nir_shader *shader, nir_op op)
 {
    unsigned num_srcs = nir_op_infos[op].num_inputs;
-   /* TODO: don't use rzalloc */
+   /* ALU instructions are by far the most common ones, so skip zeroing
+    * and initialize every field explicitly instead.
+    */
    nir_alu_instr *instr =
-      rzalloc_size(shader,
-                   sizeof(nir_alu_instr) + num_srcs * sizeof(nir_alu_src));
+      ralloc_size(shader,
+                  sizeof(nir_alu_instr) + num_srcs * sizeof(nir_alu_src));
 
    instr_init(&instr->instr, nir_instr_type_alu);
    instr->op = op;
+   instr->exact = false;
+   instr->no_signed_wrap = false;
+   instr->no_unsigned_wrap = false;
    alu_dest_init(&instr->dest);
    for (unsigned i = 0; i < num_srcs; i++)
       alu_src_init(&instr->src[i]);
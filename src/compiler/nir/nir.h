@@ -44,11 +44,9 @@
 #include "compiler/shader_info.h"
 #define XXH_INLINE_ALL
 #include "util/xxhash.h"
-#include <stdio.h>
-
-#ifndef NDEBUG
 #include "util/debug.h"
-#endif /* NDEBUG */
+#include "util/os_time.h"
+#include <stdio.h>
 
 #include "nir_opcodes.h"
 
@@ -4174,6 +4172,7 @@ void nir_shader_serialize_deserialize(nir_shader *s);
 
 #ifndef NDEBUG
 void nir_validate_shader(nir_shader *shader, const char *when);
+void nir_validate_shader_sampled(nir_shader *shader, const char *when);
 void nir_validate_ssa_dominance(nir_shader *shader, const char *when);
 void nir_metadata_set_validation_flag(nir_shader *shader);
 void nir_metadata_check_validation_flag(nir_shader *shader);
@@ -4229,6 +4228,7 @@ should_print_nir(nir_shader *shader)
 }
 #else
 static inline void nir_validate_shader(nir_shader *shader, const char *when) { (void) shader; (void)when; }
+static inline void nir_validate_shader_sampled(nir_shader *shader, const char *when) { (void) shader; (void)when; }
 static inline void nir_validate_ssa_dominance(nir_shader *shader, const char *when) { (void) shader; (void)when; }
 static inline void nir_metadata_set_validation_flag(nir_shader *shader) { (void) shader; }
 static inline void nir_metadata_check_validation_flag(nir_shader *shader) { (void) shader; }
@@ -4238,6 +4238,31 @@ static inline bool should_serialize_deserialize_nir(void) { return false; }
 static inline bool should_print_nir(nir_shader *shader) { return false; }
 #endif /* NDEBUG */
 
+void nir_pass_stats_record(const char *name, bool progress, int64_t time_ns);
+
+static inline bool
+should_record_nir_pass_stats(void)
+{
+   static int record_stats = -1;
+   if (record_stats < 0)
+      record_stats = env_var_as_boolean("NIR_PASS_STATS", false);
+
+   return record_stats;
+}
+
+static inline int64_t
+nir_pass_stats_begin(void)
+{
+   return should_record_nir_pass_stats() ? os_time_get_nano() : 0;
+}
+
+static inline void
+nir_pass_stats_end(const char *name, bool progress, int64_t start)
+{
+   if (start)
+      nir_pass_stats_record(name, progress, os_time_get_nano() - start);
+}
+
 #define _PASS(pass, nir, do_pass) do {                               \
    if (should_skip_nir(#pass)) {                                     \
       printf("skipping %s\n", #pass);                                \
@@ -4257,8 +4282,11 @@ static inline bool should_print_nir(nir_shader *shader) { return false; }
    nir_metadata_set_validation_flag(nir);                            \
    if (should_print_nir(nir))                                           \
       printf("%s\n", #pass);                                         \
-   if (pass(nir, ##__VA_ARGS__)) {                                   \
-      nir_validate_shader(nir, "after " #pass);                      \
+   int64_t _nir_pass_start = nir_pass_stats_begin();                 \
+   bool _nir_pass_progress = pass(nir, ##__VA_ARGS__);               \
+   nir_pass_stats_end(#pass, _nir_pass_progress, _nir_pass_start);   \
+   if (_nir_pass_progress) {                                         \
+      nir_validate_shader_sampled(nir, "after " #pass);              \
       progress = true;                                               \
       if (should_print_nir(nir))                                        \
          nir_print_shader(nir, stdout);                              \
@@ -4269,8 +4297,10 @@ static inline bool should_print_nir(nir_shader *shader) { return false; }
 #define NIR_PASS_V(nir, pass, ...) _PASS(pass, nir,                  \
    if (should_print_nir(nir))                                           \
       printf("%s\n", #pass);                                         \
+   int64_t _nir_pass_start = nir_pass_stats_begin();                 \
    pass(nir, ##__VA_ARGS__);                                         \
-   nir_validate_shader(nir, "after " #pass);                         \
+   nir_pass_stats_end(#pass, false, _nir_pass_start);                \
+   nir_validate_shader_sampled(nir, "after " #pass);                 \
    if (should_print_nir(nir))                                           \
       nir_print_shader(nir, stdout);                                 \
 )
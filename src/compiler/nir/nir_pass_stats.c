@@ -0,0 +1,138 @@
+/*
+ * Copyright © 2020 The Mesa Authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/*
+ * Per-pass statistics for NIR_PASS/NIR_PASS_V, enabled with
+ * NIR_PASS_STATS=true.  For every pass name we count how often it ran, how
+ * often it reported progress and how much time it took in total.  The
+ * table is printed to stderr when the process exits.
+ *
+ * Passes run through NIR_PASS_V don't report progress, so they only show
+ * up in the call count and time columns.
+ */
+
+#include <stdlib.h>
+
+#include "nir.h"
+#include "util/hash_table.h"
+#include "util/simple_mtx.h"
+
+struct nir_pass_stat {
+   const char *name;
+   uint64_t calls;
+   uint64_t progress;
+   int64_t time_ns;
+};
+
+static simple_mtx_t nir_pass_stats_mutex = _SIMPLE_MTX_INITIALIZER_NP;
+static struct hash_table *nir_pass_stats_table = NULL;
+
+static int
+compare_pass_stat_time(const void *_a, const void *_b)
+{
+   const struct nir_pass_stat *a = *(const struct nir_pass_stat **)_a;
+   const struct nir_pass_stat *b = *(const struct nir_pass_stat **)_b;
+
+   if (a->time_ns != b->time_ns)
+      return a->time_ns < b->time_ns ? 1 : -1;
+   return strcmp(a->name, b->name);
+}
+
+static void
+nir_pass_stats_print(void)
+{
+   simple_mtx_lock(&nir_pass_stats_mutex);
+
+   unsigned count = nir_pass_stats_table->entries;
+   struct nir_pass_stat **stats = malloc(count * sizeof(*stats));
+   if (!stats) {
+      simple_mtx_unlock(&nir_pass_stats_mutex);
+      return;
+   }
+
+   unsigned i = 0;
+   int64_t total_ns = 0;
+   hash_table_foreach(nir_pass_stats_table, entry) {
+      stats[i] = entry->data;
+      total_ns += stats[i]->time_ns;
+      i++;
+   }
+
+   qsort(stats, count, sizeof(*stats), compare_pass_stat_time);
+
+   fprintf(stderr, "NIR pass statistics:\n");
+   fprintf(stderr, "%-40s %10s %10s %12s %7s\n",
+           "pass", "calls", "progress", "time (ms)", "time %");
+   for (i = 0; i < count; i++) {
+      fprintf(stderr, "%-40s %10" PRIu64 " %10" PRIu64 " %12.3f %6.2f%%\n",
+              stats[i]->name, stats[i]->calls, stats[i]->progress,
+              stats[i]->time_ns / 1000000.0,
+              total_ns ? stats[i]->time_ns * 100.0 / total_ns : 0.0);
+   }
+
+   free(stats);
+
+   simple_mtx_unlock(&nir_pass_stats_mutex);
+}
+
+void
+nir_pass_stats_record(const char *name, bool progress, int64_t time_ns)
+{
+   simple_mtx_lock(&nir_pass_stats_mutex);
+
+   if (!nir_pass_stats_table) {
+      nir_pass_stats_table =
+         _mesa_hash_table_create(NULL, _mesa_hash_string,
+                                 _mesa_key_string_equal);
+      if (!nir_pass_stats_table) {
+         simple_mtx_unlock(&nir_pass_stats_mutex);
+         return;
+      }
+      atexit(nir_pass_stats_print);
+   }
+
+   struct nir_pass_stat *stat;
+   struct hash_entry *entry =
+      _mesa_hash_table_search(nir_pass_stats_table, name);
+   if (entry) {
+      stat = entry->data;
+   } else {
+      stat = rzalloc(nir_pass_stats_table, struct nir_pass_stat);
+      if (!stat) {
+         simple_mtx_unlock(&nir_pass_stats_mutex);
+         return;
+      }
+      /* Pass names come from stringizing the pass in NIR_PASS, so they are
+       * string literals which stay around for the lifetime of the process.
+       */
+      stat->name = name;
+      _mesa_hash_table_insert(nir_pass_stats_table, name, stat);
+   }
+
+   stat->calls++;
+   if (progress)
+      stat->progress++;
+   stat->time_ns += time_ns;
+
+   simple_mtx_unlock(&nir_pass_stats_mutex);
+}
@@ -26,10 +26,13 @@
  */
 
 #include <inttypes.h>
+#include <stdlib.h>
 #include "nir_search.h"
 #include "nir_builder.h"
 #include "nir_worklist.h"
+#include "util/debug.h"
 #include "util/half_float.h"
+#include "util/simple_mtx.h"
 
 /* This should be the same as nir_search_max_comm_ops in nir_algebraic.py. */
 #define NIR_SEARCH_MAX_COMM_OPS 8
@@ -577,7 +580,7 @@ construct_value(nir_builder *build,
    }
 }
 
-UNUSED static void dump_value(const nir_search_value *val)
+static void dump_value(const nir_search_value *val)
 {
    switch (val->type) {
    case nir_search_value_constant: {
@@ -647,6 +650,142 @@ UNUSED static void dump_value(const nir_search_value *val)
       fprintf(stderr, "@%d", val->bit_size);
 }
 
+/*
+ * Per-pattern statistics, enabled with NIR_ALGEBRAIC_STATS=true.  For every
+ * transform we count how often its search expression was tried against an
+ * instruction the automaton had flagged and how often it matched.  The
+ * table is printed to stderr at exit, most frequently matching first, so
+ * hot and never-firing patterns are easy to spot.
+ */
+struct algebraic_stat {
+   const struct transform *xform;
+   uint64_t tries;
+   uint64_t matches;
+};
+
+static simple_mtx_t algebraic_stats_mutex = _SIMPLE_MTX_INITIALIZER_NP;
+static struct hash_table *algebraic_stats_table = NULL;
+
+static bool
+should_record_algebraic_stats(void)
+{
+   static int record_stats = -1;
+   if (record_stats < 0)
+      record_stats = env_var_as_boolean("NIR_ALGEBRAIC_STATS", false);
+
+   return record_stats;
+}
+
+/* nir_algebraic.py emits a copy of a transform in every state's xforms
+ * array that can reach it, but the copies all point at the same search and
+ * replace expressions, so key the table on those rather than on the
+ * transform itself.
+ */
+static uint32_t
+algebraic_stat_hash(const void *key)
+{
+   const struct transform *xform = key;
+   uint32_t hash = _mesa_hash_pointer(xform->search);
+   hash = hash * 31 + _mesa_hash_pointer(xform->replace);
+   return hash * 31 + xform->condition_offset;
+}
+
+static bool
+algebraic_stat_equal(const void *a, const void *b)
+{
+   const struct transform *xa = a, *xb = b;
+   return xa->search == xb->search && xa->replace == xb->replace &&
+          xa->condition_offset == xb->condition_offset;
+}
+
+static int
+compare_algebraic_stat(const void *_a, const void *_b)
+{
+   const struct algebraic_stat *a = *(const struct algebraic_stat **)_a;
+   const struct algebraic_stat *b = *(const struct algebraic_stat **)_b;
+
+   if (a->matches != b->matches)
+      return a->matches < b->matches ? 1 : -1;
+   if (a->tries != b->tries)
+      return a->tries < b->tries ? 1 : -1;
+   return 0;
+}
+
+static void
+algebraic_stats_print(void)
+{
+   simple_mtx_lock(&algebraic_stats_mutex);
+
+   unsigned count = algebraic_stats_table->entries;
+   struct algebraic_stat **stats = malloc(count * sizeof(*stats));
+   if (!stats) {
+      simple_mtx_unlock(&algebraic_stats_mutex);
+      return;
+   }
+
+   unsigned i = 0;
+   hash_table_foreach(algebraic_stats_table, entry)
+      stats[i++] = entry->data;
+
+   qsort(stats, count, sizeof(*stats), compare_algebraic_stat);
+
+   fprintf(stderr, "NIR algebraic pattern statistics:\n");
+   fprintf(stderr, "%12s %12s  pattern\n", "matches", "tries");
+   for (i = 0; i < count; i++) {
+      fprintf(stderr, "%12" PRIu64 " %12" PRIu64 "  ",
+              stats[i]->matches, stats[i]->tries);
+      dump_value(&stats[i]->xform->search->value);
+      fprintf(stderr, " -> ");
+      dump_value(stats[i]->xform->replace);
+      fprintf(stderr, "\n");
+   }
+
+   free(stats);
+
+   simple_mtx_unlock(&algebraic_stats_mutex);
+}
+
+static void
+algebraic_stats_record(const struct transform *xform, bool matched)
+{
+   simple_mtx_lock(&algebraic_stats_mutex);
+
+   if (!algebraic_stats_table) {
+      algebraic_stats_table =
+         _mesa_hash_table_create(NULL, algebraic_stat_hash,
+                                 algebraic_stat_equal);
+      if (!algebraic_stats_table) {
+         simple_mtx_unlock(&algebraic_stats_mutex);
+         return;
+      }
+      atexit(algebraic_stats_print);
+   }
+
+   struct algebraic_stat *stat;
+   struct hash_entry *entry =
+      _mesa_hash_table_search(algebraic_stats_table, xform);
+   if (entry) {
+      stat = entry->data;
+   } else {
+      stat = rzalloc(algebraic_stats_table, struct algebraic_stat);
+      if (!stat) {
+         simple_mtx_unlock(&algebraic_stats_mutex);
+         return;
+      }
+      /* Transforms live in the static tables generated by nir_algebraic.py,
+       * so the pointer stays valid for the lifetime of the process.
+       */
+      stat->xform = xform;
+      _mesa_hash_table_insert(algebraic_stats_table, xform, stat);
+   }
+
+   stat->tries++;
+   if (matched)
+      stat->matches++;
+
+   simple_mtx_unlock(&algebraic_stats_mutex);
+}
+
 static void
 add_uses_to_worklist(nir_instr *instr,
                      nir_instr_worklist *worklist,
@@ -881,14 +1020,23 @@ nir_algebraic_instr(nir_builder *build, nir_instr *instr,
       nir_is_float_control_signed_zero_inf_nan_preserve(execution_mode, bit_size) ||
       nir_is_denorm_flush_to_zero(execution_mode, bit_size);
 
+   const bool record_stats = should_record_algebraic_stats();
+
    int xform_idx = *util_dynarray_element(states, uint16_t,
                                           alu->dest.dest.ssa.index);
    for (uint16_t i = 0; i < transform_counts[xform_idx]; i++) {
       const struct transform *xform = &transforms[xform_idx][i];
-      if (condition_flags[xform->condition_offset] &&
-          !(xform->search->inexact && ignore_inexact) &&
-          nir_replace_instr(build, alu, range_ht, states, pass_op_table,
-                            xform->search, xform->replace, worklist)) {
+      if (!condition_flags[xform->condition_offset] ||
+          (xform->search->inexact && ignore_inexact))
+         continue;
+
+      bool matched = nir_replace_instr(build, alu, range_ht, states,
+                                       pass_op_table, xform->search,
+                                       xform->replace, worklist) != NULL;
+      if (record_stats)
+         algebraic_stats_record(xform, matched);
+
+      if (matched) {
          _mesa_hash_table_clear(range_ht, NULL);
          return true;
       }
@@ -1916,6 +1916,20 @@ read_cf_list(read_ctx *ctx, struct exec_list *cf_list)
 static void
 write_function_impl(write_ctx *ctx, const nir_function_impl *fi)
 {
+   /* Every impl is preceded by its size in bytes and the number of objects
+    * it adds to the remap table, so that readers can skip it.  For the same
+    * reason, the type and variable data compression doesn't refer back to
+    * anything written before the impl.
+    */
+   size_t size_offset = blob_reserve_uint32(ctx->blob);
+   size_t num_objects_offset = blob_reserve_uint32(ctx->blob);
+   size_t start = ctx->blob->size;
+   uint32_t first_idx = ctx->next_idx;
+
+   ctx->last_type = NULL;
+   ctx->last_interface_type = NULL;
+   memset(&ctx->last_var_data, 0, sizeof(ctx->last_var_data));
+
    blob_write_uint8(ctx->blob, fi->structured);
 
    write_var_list(ctx, &fi->locals);
@@ -1924,11 +1938,42 @@ write_function_impl(write_ctx *ctx, const nir_function_impl *fi)
 
    write_cf_list(ctx, &fi->body);
    write_fixup_phis(ctx);
+
+   blob_overwrite_uint32(ctx->blob, size_offset, ctx->blob->size - start);
+   blob_overwrite_uint32(ctx->blob, num_objects_offset,
+                         ctx->next_idx - first_idx);
+}
+
+static void
+reset_read_compression_state(read_ctx *ctx)
+{
+   ctx->last_type = NULL;
+   ctx->last_interface_type = NULL;
+   memset(&ctx->last_var_data, 0, sizeof(ctx->last_var_data));
+}
+
+static void
+skip_function_impl(read_ctx *ctx)
+{
+   uint32_t size = blob_read_uint32(ctx->blob);
+   uint32_t num_objects = blob_read_uint32(ctx->blob);
+
+   /* Nothing outside of the impl can refer to its objects, so leaving
+    * their idx_table entries NULL is fine.
+    */
+   assert(ctx->next_idx + num_objects <= ctx->idx_table_len);
+   ctx->next_idx += num_objects;
+   blob_skip_bytes(ctx->blob, size);
 }
 
 static nir_function_impl *
 read_function_impl(read_ctx *ctx, nir_function *fxn)
 {
+   /* The size and number of objects are only needed for skipping. */
+   UNUSED uint32_t size = blob_read_uint32(ctx->blob);
+   UNUSED uint32_t num_objects = blob_read_uint32(ctx->blob);
+   reset_read_compression_state(ctx);
+
    nir_function_impl *fi = nir_function_impl_create_bare(ctx->nir);
    fi->function = fxn;
 
@@ -2060,10 +2105,11 @@ nir_serialize(struct blob *blob, const nir_shader *nir, bool strip)
    util_dynarray_fini(&ctx.phi_fixups);
 }
 
-nir_shader *
-nir_deserialize(void *mem_ctx,
-                const struct nir_shader_compiler_options *options,
-                struct blob_reader *blob)
+static nir_shader *
+deserialize(void *mem_ctx,
+            const struct nir_shader_compiler_options *options,
+            struct blob_reader *blob,
+            enum nir_deserialize_impls impls)
 {
    read_ctx ctx = {0};
    ctx.blob = blob;
@@ -2098,8 +2144,16 @@ nir_deserialize(void *mem_ctx,
       read_function(&ctx);
 
    nir_foreach_function(fxn, ctx.nir) {
-      if (fxn->impl == NIR_SERIALIZE_FUNC_HAS_IMPL)
+      if (fxn->impl != NIR_SERIALIZE_FUNC_HAS_IMPL)
+         continue;
+
+      if (impls == nir_deserialize_all_impls ||
+          (impls == nir_deserialize_entrypoint_impl && fxn->is_entrypoint)) {
          fxn->impl = read_function_impl(&ctx, fxn);
+      } else {
+         skip_function_impl(&ctx);
+         fxn->impl = NULL;
+      }
    }
 
    ctx.nir->constant_data_size = blob_read_uint32(blob);
@@ -2115,6 +2169,32 @@ nir_deserialize(void *mem_ctx,
    return ctx.nir;
 }
 
+nir_shader *
+nir_deserialize(void *mem_ctx,
+                const struct nir_shader_compiler_options *options,
+                struct blob_reader *blob)
+{
+   return deserialize(mem_ctx, options, blob, nir_deserialize_all_impls);
+}
+
+/**
+ * Deserialize a shader, but only materialize some of its function impls.
+ *
+ * Functions whose impl is skipped are still declared, but have a NULL impl.
+ * With nir_deserialize_no_impls only the shader info, the variables and the
+ * function signatures are read, which is enough for link-time inspection.
+ * It's up to the caller to make sure the impls that are read don't call any
+ * of the skipped ones.
+ */
+nir_shader *
+nir_deserialize_partial(void *mem_ctx,
+                        const struct nir_shader_compiler_options *options,
+                        struct blob_reader *blob,
+                        enum nir_deserialize_impls impls)
+{
+   return deserialize(mem_ctx, options, blob, impls);
+}
+
 void
 nir_shader_serialize_deserialize(nir_shader *shader)
 {
@@ -36,6 +36,17 @@ nir_shader *nir_deserialize(void *mem_ctx,
                             const struct nir_shader_compiler_options *options,
                             struct blob_reader *blob);
 
+enum nir_deserialize_impls {
+   nir_deserialize_all_impls,
+   nir_deserialize_entrypoint_impl,
+   nir_deserialize_no_impls,
+};
+
+nir_shader *nir_deserialize_partial(void *mem_ctx,
+                                    const struct nir_shader_compiler_options *options,
+                                    struct blob_reader *blob,
+                                    enum nir_deserialize_impls impls);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
@@ -27,6 +27,7 @@
 
 #include "nir.h"
 #include "c11/threads.h"
+#include "util/u_atomic.h"
 #include <assert.h>
 
 /*
@@ -1607,8 +1608,83 @@ dump_errors(validate_state *state, const char *when)
    abort();
 }
 
-void
-nir_validate_shader(nir_shader *shader, const char *when)
+static bool
+validate_src_parent(nir_src *src, void *_state)
+{
+   validate_state *state = _state;
+
+   validate_assert(state, src->parent_instr == state->instr);
+   if (src->is_ssa)
+      validate_assert(state, src->ssa != NULL);
+   else
+      validate_assert(state, src->reg.reg != NULL);
+
+   return true;
+}
+
+static bool
+validate_ssa_def_parent(nir_ssa_def *def, void *_state)
+{
+   validate_state *state = _state;
+
+   validate_assert(state, def->parent_instr == state->instr);
+   validate_assert(state, def->index < state->impl->ssa_alloc);
+
+   return true;
+}
+
+/**
+ * Cheap structural validation used for the NIR_PASS calls which are skipped
+ * by NIR_VALIDATE_INTERVAL.  It doesn't build any use/def sets, it only
+ * checks that instructions, sources and SSA defs point back to where they
+ * live, which catches the most common kind of broken IR early.
+ */
+static void
+validate_shader_structure(nir_shader *shader, validate_state *state)
+{
+   nir_foreach_function(func, shader) {
+      if (func->impl == NULL)
+         continue;
+
+      state->impl = func->impl;
+      validate_assert(state, func->impl->function == func);
+
+      nir_foreach_block(block, func->impl) {
+         state->block = block;
+         exec_list_validate(&block->instr_list);
+
+         nir_foreach_instr(instr, block) {
+            state->instr = instr;
+            validate_assert(state, instr->block == block);
+            nir_foreach_src(instr, validate_src_parent, state);
+            nir_foreach_ssa_def(instr, validate_ssa_def_parent, state);
+         }
+         state->instr = NULL;
+      }
+   }
+}
+
+/**
+ * With NIR_VALIDATE_INTERVAL=N only every Nth validation requested through
+ * nir_validate_shader_sampled() (i.e. by NIR_PASS) runs the full validator,
+ * the others only do the structural checks.
+ */
+static bool
+should_validate_fully(void)
+{
+   static int validate_interval = -1;
+   if (validate_interval < 0)
+      validate_interval = env_var_as_unsigned("NIR_VALIDATE_INTERVAL", 1);
+
+   if (validate_interval <= 1)
+      return true;
+
+   static uint32_t pass_count = 0;
+   return p_atomic_inc_return(&pass_count) % validate_interval == 0;
+}
+
+static void
+validate_shader(nir_shader *shader, const char *when, bool sampled)
 {
    static int should_validate = -1;
    if (should_validate < 0)
@@ -1619,6 +1695,17 @@ nir_validate_shader(nir_shader *shader, const char *when)
    validate_state state;
    init_validate_state(&state);
 
+   if (sampled && !should_validate_fully()) {
+      state.shader = shader;
+      validate_shader_structure(shader, &state);
+
+      if (_mesa_hash_table_num_entries(state.errors) > 0)
+         dump_errors(&state, when);
+
+      destroy_validate_state(&state);
+      return;
+   }
+
    state.shader = shader;
 
    nir_variable_mode valid_modes =
@@ -1656,6 +1743,22 @@ nir_validate_shader(nir_shader *shader, const char *when)
    destroy_validate_state(&state);
 }
 
+void
+nir_validate_shader(nir_shader *shader, const char *when)
+{
+   validate_shader(shader, when, false);
+}
+
+/**
+ * Like nir_validate_shader(), but subject to NIR_VALIDATE_INTERVAL.  Used
+ * by NIR_PASS, validation anywhere else is always done in full.
+ */
+void
+nir_validate_shader_sampled(nir_shader *shader, const char *when)
+{
+   validate_shader(shader, when, true);
+}
+
 void
 nir_validate_ssa_dominance(nir_shader *shader, const char *when)
 {
@@ -34,7 +34,7 @@ protected:
    nir_serialize_test();
    ~nir_serialize_test();
 
-   void serialize();
+   void serialize(enum nir_deserialize_impls impls = nir_deserialize_all_impls);
    nir_alu_instr *get_last_alu(nir_shader *);
    void ASSERT_SWIZZLE_EQ(nir_alu_instr *, nir_alu_instr *, unsigned count, unsigned src);
 
@@ -68,7 +68,7 @@ nir_serialize_test::~nir_serialize_test()
 }
 
 void
-nir_serialize_test::serialize() {
+nir_serialize_test::serialize(enum nir_deserialize_impls impls) {
    struct blob blob;
    struct blob_reader reader;
 
@@ -76,7 +76,10 @@ nir_serialize_test::serialize() {
 
    nir_serialize(&blob, b->shader, false);
    blob_reader_init(&reader, blob.data, blob.size);
-   nir_shader *cloned = nir_deserialize(b->shader, &options, &reader);
+   nir_shader *cloned = nir_deserialize_partial(b->shader, &options, &reader,
+                                                impls);
+   ASSERT_FALSE(reader.overrun);
+   ASSERT_EQ(reader.current, reader.end);
    blob_finish(&blob);
 
    dup = cloned;
@@ -279,3 +282,45 @@ TEST_P(nir_serialize_all_but_one_test, single_channel)
 
    ASSERT_SWIZZLE_EQ(vec_alu, vec_alu_dup, 1, 0);
 }
+
+TEST_P(nir_serialize_all_test, partial_skips_other_impls)
+{
+   /* Put a helper function with its own locals and instructions in front of
+    * the entrypoint, so that skipping it has to get the object indices and
+    * the type compression state of the entrypoint right.
+    */
+   nir_function *helper = nir_function_create(b->shader, "helper");
+   nir_function_impl *helper_impl = nir_function_impl_create(helper);
+   nir_builder hb;
+   nir_builder_init(&hb, helper_impl);
+   hb.cursor = nir_after_cf_list(&helper_impl->body);
+   nir_local_variable_create(helper_impl, glsl_vec4_type(), "helper_tmp");
+   nir_ssa_def *one = nir_imm_float(&hb, 1.0f);
+   nir_fadd(&hb, one, one);
+
+   nir_function *entry = nir_shader_get_entrypoint(b->shader)->function;
+   exec_node_remove(&entry->node);
+   exec_list_push_tail(&b->shader->functions, &entry->node);
+
+   nir_local_variable_create(b->impl, glsl_uint_type(), "main_tmp");
+   nir_ssa_def *zero = nir_imm_zero(b, GetParam(), 32);
+   nir_ssa_def *fmax = nir_fmax(b, zero, zero);
+   nir_alu_instr *fmax_alu = nir_instr_as_alu(fmax->parent_instr);
+
+   serialize(nir_deserialize_entrypoint_impl);
+
+   nir_foreach_function(func, dup) {
+      if (func->is_entrypoint) {
+         ASSERT_NE(func->impl, nullptr);
+         nir_foreach_function_temp_variable(var, func->impl)
+            ASSERT_EQ(var->type, glsl_uint_type());
+      } else {
+         ASSERT_EQ(func->impl, nullptr);
+      }
+   }
+
+   nir_alu_instr *fmax_alu_dup = get_last_alu(dup);
+   ASSERT_EQ(fmax_alu_dup->op, nir_op_fmax);
+   ASSERT_SWIZZLE_EQ(fmax_alu, fmax_alu_dup, GetParam(), 0);
+   ASSERT_SWIZZLE_EQ(fmax_alu, fmax_alu_dup, GetParam(), 1);
+}
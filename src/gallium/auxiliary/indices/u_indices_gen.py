@@ -1,5 +1,13 @@
 from __future__ import print_function
 
+import re
+import sys
+
+try:
+    from StringIO import StringIO
+except ImportError:
+    from io import StringIO
+
 copyright = '''
 /*
  * Copyright 2009 VMware, Inc.
@@ -84,6 +92,31 @@ def prolog():
 #include "util/u_debug.h"
 #include "util/u_memory.h"
 
+#if defined(PIPE_ARCH_SSE)
+#include <emmintrin.h>
+
+/* Pack the low 16 bits of each 32-bit lane of a and b into 8 ushorts.
+ * Sign-extending first keeps _mm_packs_epi32 from saturating.
+ */
+static inline __m128i
+u_indices_pack_ushort(__m128i a, __m128i b)
+{
+   a = _mm_srai_epi32(_mm_slli_epi32(a, 16), 16);
+   b = _mm_srai_epi32(_mm_slli_epi32(b, 16), 16);
+   return _mm_packs_epi32(a, b);
+}
+
+static inline __m128i
+u_indices_load_ubyte4(const ubyte *in)
+{
+   uint32_t v;
+   memcpy(&v, in, sizeof(v));
+   return _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(v),
+                                                _mm_setzero_si128()),
+                             _mm_setzero_si128());
+}
+#endif
+
 
 static unsigned out_size_idx( unsigned index_size )
 {
@@ -226,6 +259,89 @@ def prim_restart(in_verts, out_verts, out_prims, close_func = None):
         print('         goto restart;')
         print('      }')
 
+# SSE2 versions of the hottest translations (quads and line strips/loops
+# without primitive restart).  They work on 32-bit lanes: the input is
+# widened on load and packed back to ushort on store, so one kernel covers
+# every in/out type.  The scalar loop handles whatever is left over.
+
+def capture_offsets(func, *args):
+    """Run one of the do_* emitters for a generated primitive and return
+    the vertex offset written to each output slot, in output order."""
+    saved = sys.stdout
+    sys.stdout = captured = StringIO()
+    try:
+        func(GENERATE, 'uint', 'out', *args)
+    finally:
+        sys.stdout = saved
+    return [int(v) for v in re.findall(r'\(uint\)\((\d+)\);', captured.getvalue())]
+
+def sse_load4(intype, reg, offset):
+    if intype == GENERATE:
+        print('      ' + reg + ' = _mm_add_epi32(_mm_set1_epi32(i + ' + offset + '), _mm_setr_epi32(0, 1, 2, 3));')
+    elif intype == UBYTE:
+        print('      ' + reg + ' = u_indices_load_ubyte4(&in[i + ' + offset + ']);')
+    elif intype == USHORT:
+        print('      ' + reg + ' = _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i *)&in[i + ' + offset + ']), _mm_setzero_si128());')
+    else:
+        print('      ' + reg + ' = _mm_loadu_si128((const __m128i *)&in[i + ' + offset + ']);')
+
+def sse_store(outtype, regs):
+    if outtype == UINT:
+        for n, reg in enumerate(regs):
+            print('      _mm_storeu_si128((__m128i *)&out[j + ' + str(4 * n) + '], ' + reg + ');')
+    else:
+        for n in range(0, len(regs), 2):
+            if n + 1 < len(regs):
+                print('      _mm_storeu_si128((__m128i *)&out[j + ' + str(4 * n) + '], u_indices_pack_ushort(' + regs[n] + ', ' + regs[n + 1] + '));')
+            else:
+                print('      _mm_storel_epi64((__m128i *)&out[j + ' + str(4 * n) + '], u_indices_pack_ushort(' + regs[n] + ', ' + regs[n] + '));')
+
+def shuffle(a, b, c, d):
+    return '_MM_SHUFFLE(' + str(d) + ', ' + str(c) + ', ' + str(b) + ', ' + str(a) + ')'
+
+def sse_quads(intype, outtype, inpv, outpv):
+    # Two quads per iteration: 8 input vertices, 12 output vertices.
+    o = capture_offsets(do_quad, '0', '1', '2', '3', inpv, outpv)
+    print('#if defined(PIPE_ARCH_SSE)')
+    print('  for (; j + 12 <= out_nr; j += 12, i += 8) {')
+    print('      __m128i q0, q1, r0, r1, r2;')
+    if intype == UBYTE:
+        print('      q0 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)&in[i]), _mm_setzero_si128());')
+        print('      q1 = _mm_unpackhi_epi16(q0, _mm_setzero_si128());')
+        print('      q0 = _mm_unpacklo_epi16(q0, _mm_setzero_si128());')
+    elif intype == USHORT:
+        print('      q0 = _mm_loadu_si128((const __m128i *)&in[i]);')
+        print('      q1 = _mm_unpackhi_epi16(q0, _mm_setzero_si128());')
+        print('      q0 = _mm_unpacklo_epi16(q0, _mm_setzero_si128());')
+    else:
+        sse_load4(intype, 'q0', '0')
+        sse_load4(intype, 'q1', '4')
+    print('      r0 = _mm_shuffle_epi32(q0, ' + shuffle(o[0], o[1], o[2], o[3]) + ');')
+    print('      r1 = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(q0), _mm_castsi128_ps(q1),')
+    print('                                           ' + shuffle(o[4], o[5], o[0], o[1]) + '));')
+    print('      r2 = _mm_shuffle_epi32(q1, ' + shuffle(o[2], o[3], o[4], o[5]) + ');')
+    sse_store(outtype, ['r0', 'r1', 'r2'])
+    print('   }')
+    print('#endif')
+
+def sse_linestrip(intype, outtype, inpv, outpv, limit):
+    # Four segments per iteration: vertices i..i+4, 8 output vertices.
+    o = capture_offsets(do_line, '0', '1', inpv, outpv)
+    print('#if defined(PIPE_ARCH_SSE)')
+    print('  for (; j + ' + limit + ' <= out_nr; j += 8, i += 4) {')
+    print('      __m128i v0, v1, r0, r1;')
+    sse_load4(intype, 'v0', '0')
+    sse_load4(intype, 'v1', '1')
+    if o == [0, 1]:
+        print('      r0 = _mm_unpacklo_epi32(v0, v1);')
+        print('      r1 = _mm_unpackhi_epi32(v0, v1);')
+    else:
+        print('      r0 = _mm_unpacklo_epi32(v1, v0);')
+        print('      r1 = _mm_unpackhi_epi32(v1, v0);')
+    sse_store(outtype, ['r0', 'r1'])
+    print('   }')
+    print('#endif')
+
 def points(intype, outtype, inpv, outpv, pr):
     preamble(intype, outtype, inpv, outpv, pr, prim='points')
     print('  for (i = start, j = 0; j < out_nr; j++, i++) { ')
@@ -242,7 +358,10 @@ def lines(intype, outtype, inpv, outpv, pr):
 
 def linestrip(intype, outtype, inpv, outpv, pr):
     preamble(intype, outtype, inpv, outpv, pr, prim='linestrip')
-    print('  for (i = start, j = 0; j < out_nr; j+=2, i++) { ')
+    print('  i = start;')
+    print('  j = 0;')
+    sse_linestrip(intype, outtype, inpv, outpv, '8')
+    print('  for (; j < out_nr; j+=2, i++) { ')
     do_line( intype, outtype, 'out+j',  'i', 'i+1', inpv, outpv );
     print('   }')
     postamble()
@@ -250,7 +369,12 @@ def linestrip(intype, outtype, inpv, outpv, pr):
 def lineloop(intype, outtype, inpv, outpv, pr):
     preamble(intype, outtype, inpv, outpv, pr, prim='lineloop')
     print('  unsigned end = start;')
-    print('  for (i = start, j = 0; j < out_nr - 2; j+=2, i++) { ')
+    print('  i = start;')
+    print('  j = 0;')
+    if pr == PRDISABLE:
+        sse_linestrip(intype, outtype, inpv, outpv, '8 + 2')
+        print('  end = i;')
+    print('  for (; j < out_nr - 2; j+=2, i++) { ')
     if pr == PRENABLE:
         def close_func(index):
             do_line( intype, outtype, 'out+j',  'end', 'start', inpv, outpv )
@@ -322,7 +446,11 @@ def polygon(intype, outtype, inpv, outpv, pr):
 
 def quads(intype, outtype, inpv, outpv, pr):
     preamble(intype, outtype, inpv, outpv, pr, prim='quads')
-    print('  for (i = start, j = 0; j < out_nr; j+=6, i+=4) { ')
+    print('  i = start;')
+    print('  j = 0;')
+    if pr == PRDISABLE:
+        sse_quads(intype, outtype, inpv, outpv)
+    print('  for (; j < out_nr; j+=6, i+=4) { ')
     if pr == PRENABLE:
         prim_restart(4, 3, 2)
 
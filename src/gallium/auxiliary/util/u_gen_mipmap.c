@@ -37,7 +37,14 @@
 
 #include "util/u_gen_mipmap.h"
 #include "util/format/u_format.h"
+#include "util/u_box.h"
 #include "util/u_inlines.h"
+#include "util/u_math.h"
+#include "util/format_srgb.h"
+
+#if defined(PIPE_ARCH_SSE)
+#include <emmintrin.h>
+#endif
 
 
 /**
@@ -126,3 +133,359 @@ util_gen_mipmap(struct pipe_context *pipe, struct pipe_resource *pt,
    }
    return TRUE;
 }
+
+
+/**
+ * Whether util_downsample_box() can filter the given format.
+ */
+bool
+util_downsample_box_supported(enum pipe_format format)
+{
+   const struct util_format_description *desc =
+      util_format_description(format);
+
+   if (!desc || desc->block.width != 1 || desc->block.height != 1)
+      return false;
+
+   if (desc->layout != UTIL_FORMAT_LAYOUT_PLAIN &&
+       desc->layout != UTIL_FORMAT_LAYOUT_OTHER)
+      return false;
+
+   if (util_format_is_depth_or_stencil(format) ||
+       util_format_is_pure_integer(format))
+      return false;
+
+   return util_format_unpack_description(format)->unpack_rgba &&
+          util_format_pack_description(format)->pack_rgba_float;
+}
+
+
+/**
+ * 2x2 box filter of one row of a non-sRGB, 4 x 8-bit unorm format.
+ */
+static void
+downsample_row_rgba8(uint8_t *dst, unsigned dst_width,
+                     const uint8_t *row0, const uint8_t *row1,
+                     unsigned src_width)
+{
+   unsigned x = 0;
+
+#if defined(PIPE_ARCH_SSE)
+   const __m128i zero = _mm_setzero_si128();
+   const __m128i two = _mm_set1_epi16(2);
+
+   /* Four source pixels from each row make two destination pixels. */
+   for (; x + 2 <= src_width / 2; x += 2) {
+      const __m128i a = _mm_loadu_si128((const __m128i *)(row0 + x * 8));
+      const __m128i b = _mm_loadu_si128((const __m128i *)(row1 + x * 8));
+      __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero),
+                                 _mm_unpacklo_epi8(b, zero));
+      __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero),
+                                 _mm_unpackhi_epi8(b, zero));
+      lo = _mm_add_epi16(lo, _mm_srli_si128(lo, 8));
+      hi = _mm_add_epi16(hi, _mm_srli_si128(hi, 8));
+
+      __m128i sum = _mm_unpacklo_epi64(lo, hi);
+      sum = _mm_srli_epi16(_mm_add_epi16(sum, two), 2);
+      _mm_storel_epi64((__m128i *)(dst + x * 4), _mm_packus_epi16(sum, sum));
+   }
+#endif
+
+   for (; x < dst_width; x++) {
+      const unsigned x0 = 2 * x * 4;
+      const unsigned x1 = MIN2(2 * x + 1, src_width - 1) * 4;
+
+      for (unsigned c = 0; c < 4; c++) {
+         dst[x * 4 + c] = (row0[x0 + c] + row0[x1 + c] +
+                           row1[x0 + c] + row1[x1 + c] + 2) >> 2;
+      }
+   }
+}
+
+
+/**
+ * 2x2x2 box filter of one row of a non-sRGB, 4 x 8-bit unorm format.
+ */
+static void
+downsample_row_rgba8_3d(uint8_t *dst, unsigned dst_width,
+                        const uint8_t *row0, const uint8_t *row1,
+                        const uint8_t *row2, const uint8_t *row3,
+                        unsigned src_width)
+{
+   for (unsigned x = 0; x < dst_width; x++) {
+      const unsigned x0 = 2 * x * 4;
+      const unsigned x1 = MIN2(2 * x + 1, src_width - 1) * 4;
+
+      for (unsigned c = 0; c < 4; c++) {
+         dst[x * 4 + c] = (row0[x0 + c] + row0[x1 + c] +
+                           row1[x0 + c] + row1[x1 + c] +
+                           row2[x0 + c] + row2[x1 + c] +
+                           row3[x0 + c] + row3[x1 + c] + 4) >> 3;
+      }
+   }
+}
+
+
+/**
+ * Box filter of one row of an sRGB, 4 x 8-bit unorm format.  The color
+ * channels are averaged in linear space, alpha as is.
+ */
+static void
+downsample_row_srgba8(uint8_t *dst, unsigned dst_width,
+                      const uint8_t **rows, unsigned num_rows,
+                      unsigned src_width, unsigned alpha_chan)
+{
+   const float scale = 1.0f / (2 * num_rows);
+
+   for (unsigned x = 0; x < dst_width; x++) {
+      const unsigned x0 = 2 * x * 4;
+      const unsigned x1 = MIN2(2 * x + 1, src_width - 1) * 4;
+
+      for (unsigned c = 0; c < 4; c++) {
+         if (c == alpha_chan) {
+            unsigned sum = 0;
+            for (unsigned r = 0; r < num_rows; r++)
+               sum += rows[r][x0 + c] + rows[r][x1 + c];
+            dst[x * 4 + c] = (sum + num_rows) / (2 * num_rows);
+         } else {
+            float sum = 0.0f;
+            for (unsigned r = 0; r < num_rows; r++) {
+               sum += util_format_srgb_8unorm_to_linear_float(rows[r][x0 + c]) +
+                      util_format_srgb_8unorm_to_linear_float(rows[r][x1 + c]);
+            }
+            dst[x * 4 + c] =
+               util_format_linear_float_to_srgb_8unorm(sum * scale);
+         }
+      }
+   }
+}
+
+
+/**
+ * Box filter of one row of any format, done in float.  sRGB formats are
+ * unpacked to linear and packed back, so they are filtered correctly.
+ */
+static void
+downsample_row_float(enum pipe_format format,
+                     uint8_t *dst, unsigned dst_width,
+                     const uint8_t **rows, unsigned num_rows,
+                     unsigned src_width, float *tmp)
+{
+   float *src = tmp + 4 * dst_width;
+   const float scale = 1.0f / (2 * num_rows);
+
+   memset(tmp, 0, 4 * dst_width * sizeof(float));
+
+   for (unsigned r = 0; r < num_rows; r++) {
+      util_format_unpack_rgba(format, src, rows[r], src_width);
+
+      for (unsigned x = 0; x < dst_width; x++) {
+         const unsigned x0 = 2 * x * 4;
+         const unsigned x1 = MIN2(2 * x + 1, src_width - 1) * 4;
+
+         for (unsigned c = 0; c < 4; c++)
+            tmp[x * 4 + c] += src[x0 + c] + src[x1 + c];
+      }
+   }
+
+   for (unsigned i = 0; i < 4 * dst_width; i++)
+      tmp[i] *= scale;
+
+   util_format_pack_rgba(format, dst, tmp, dst_width);
+}
+
+
+/**
+ * Generate rows [dst_y0, dst_y1) of a mipmap image from the next larger
+ * image with a 2x2 box filter, or a 2x2x2 one if src1 (the second source
+ * slice of a 3D texture) isn't NULL.  Odd source sizes repeat the last
+ * row/column.
+ *
+ * \return false if out of memory
+ */
+bool
+util_downsample_box(enum pipe_format format,
+                    uint8_t *dst, unsigned dst_stride, unsigned dst_width,
+                    unsigned dst_y0, unsigned dst_y1,
+                    const uint8_t *src0, const uint8_t *src1,
+                    unsigned src_stride, unsigned src_width,
+                    unsigned src_height)
+{
+   const struct util_format_description *desc =
+      util_format_description(format);
+   const bool rgba8 = util_format_is_rgba8_variant(desc);
+   const bool srgb = desc->colorspace == UTIL_FORMAT_COLORSPACE_SRGB;
+   float *tmp = NULL;
+
+   if (!rgba8) {
+      tmp = malloc((dst_width + src_width) * 4 * sizeof(float));
+      if (!tmp)
+         return false;
+   }
+
+   for (unsigned y = dst_y0; y < dst_y1; y++) {
+      const unsigned y0 = 2 * y;
+      const unsigned y1 = MIN2(2 * y + 1, src_height - 1);
+      const uint8_t *rows[4] = {
+         src0 + y0 * src_stride,
+         src0 + y1 * src_stride,
+         src1 ? src1 + y0 * src_stride : NULL,
+         src1 ? src1 + y1 * src_stride : NULL,
+      };
+      uint8_t *dst_row = dst + y * dst_stride;
+
+      if (!rgba8) {
+         downsample_row_float(format, dst_row, dst_width, rows,
+                              src1 ? 4 : 2, src_width, tmp);
+      } else if (srgb) {
+         downsample_row_srgba8(dst_row, dst_width, rows, src1 ? 4 : 2,
+                               src_width, desc->swizzle[3]);
+      } else if (src1) {
+         downsample_row_rgba8_3d(dst_row, dst_width, rows[0], rows[1],
+                                 rows[2], rows[3], src_width);
+      } else {
+         downsample_row_rgba8(dst_row, dst_width, rows[0], rows[1],
+                              src_width);
+      }
+   }
+
+   free(tmp);
+   return true;
+}
+
+
+/**
+ * Map mip level \p level for writing and the level above it for reading,
+ * over layers first_layer..last_layer (or all slices for 3D textures), in
+ * preparation for util_gen_mipmap_downsample_slice().
+ *
+ * \return false if either level couldn't be mapped
+ */
+bool
+util_gen_mipmap_map_level(struct pipe_context *pipe, struct pipe_resource *pt,
+                          enum pipe_format format, unsigned level,
+                          unsigned first_layer, unsigned last_layer,
+                          struct util_gen_mipmap_level *lvl)
+{
+   struct pipe_box src_box, dst_box;
+   const unsigned src_level = level - 1;
+
+   lvl->format = format;
+   lvl->is_3d = pt->target == PIPE_TEXTURE_3D;
+   lvl->src_depth = util_num_layers(pt, src_level);
+
+   u_box_3d(0, 0, lvl->is_3d ? 0 : first_layer,
+            u_minify(pt->width0, src_level),
+            u_minify(pt->height0, src_level),
+            lvl->is_3d ? lvl->src_depth : last_layer + 1 - first_layer,
+            &src_box);
+   u_box_3d(0, 0, lvl->is_3d ? 0 : first_layer,
+            u_minify(pt->width0, level),
+            u_minify(pt->height0, level),
+            lvl->is_3d ? util_num_layers(pt, level) :
+                         last_layer + 1 - first_layer,
+            &dst_box);
+
+   lvl->src_width = src_box.width;
+   lvl->src_height = src_box.height;
+   lvl->dst_width = dst_box.width;
+   lvl->dst_height = dst_box.height;
+   lvl->dst_depth = dst_box.depth;
+
+   lvl->src_map = pipe->transfer_map(pipe, pt, src_level, PIPE_MAP_READ,
+                                     &src_box, &lvl->src_trans);
+   if (!lvl->src_map)
+      return false;
+
+   lvl->dst_map = pipe->transfer_map(pipe, pt, level,
+                                     PIPE_MAP_WRITE | PIPE_MAP_DISCARD_RANGE,
+                                     &dst_box, &lvl->dst_trans);
+   if (!lvl->dst_map) {
+      pipe->transfer_unmap(pipe, lvl->src_trans);
+      return false;
+   }
+
+   return true;
+}
+
+
+void
+util_gen_mipmap_unmap_level(struct pipe_context *pipe,
+                            struct util_gen_mipmap_level *lvl)
+{
+   pipe->transfer_unmap(pipe, lvl->dst_trans);
+   pipe->transfer_unmap(pipe, lvl->src_trans);
+}
+
+
+/**
+ * Downsample rows dst_y0..dst_y1 of slice (or layer) \p z of a level
+ * mapped with util_gen_mipmap_map_level().  For 3D textures the two
+ * source slices 2z and 2z+1 are averaged.  Different slices and row
+ * ranges can be processed concurrently.
+ */
+bool
+util_gen_mipmap_downsample_slice(const struct util_gen_mipmap_level *lvl,
+                                 unsigned z, unsigned dst_y0, unsigned dst_y1)
+{
+   const unsigned src_layer_stride = lvl->src_trans->layer_stride;
+   const uint8_t *src0, *src1 = NULL;
+
+   if (lvl->is_3d) {
+      src0 = lvl->src_map + 2 * z * src_layer_stride;
+      if (lvl->src_depth > 1) {
+         src1 = lvl->src_map +
+                MIN2(2 * z + 1, lvl->src_depth - 1) * src_layer_stride;
+      }
+   } else {
+      src0 = lvl->src_map + z * src_layer_stride;
+   }
+
+   return util_downsample_box(lvl->format,
+                              lvl->dst_map + z * lvl->dst_trans->layer_stride,
+                              lvl->dst_trans->stride, lvl->dst_width,
+                              dst_y0, dst_y1,
+                              src0, src1, lvl->src_trans->stride,
+                              lvl->src_width, lvl->src_height);
+}
+
+
+/**
+ * Generate mipmap images on the CPU with util_downsample_box(), one layer
+ * after the other.  Same interface as pipe_context::generate_mipmap, so
+ * software drivers can plug it in directly.
+ *
+ * \return false if the format or texture can't be handled, in which case
+ *         the caller should fall back to util_gen_mipmap()
+ */
+bool
+util_gen_mipmap_cpu(struct pipe_context *pipe, struct pipe_resource *pt,
+                    enum pipe_format format, unsigned base_level,
+                    unsigned last_level, unsigned first_layer,
+                    unsigned last_layer)
+{
+   if (pt->target == PIPE_BUFFER || pt->nr_samples > 1 ||
+       !util_downsample_box_supported(format))
+      return false;
+
+   assert(last_level <= pt->last_level);
+
+   for (unsigned level = base_level + 1; level <= last_level; level++) {
+      struct util_gen_mipmap_level lvl;
+
+      if (!util_gen_mipmap_map_level(pipe, pt, format, level,
+                                     first_layer, last_layer, &lvl))
+         return false;
+
+      bool ok = true;
+      for (unsigned z = 0; ok && z < lvl.dst_depth; z++)
+         ok = util_gen_mipmap_downsample_slice(&lvl, z, 0, lvl.dst_height);
+
+      util_gen_mipmap_unmap_level(pipe, &lvl);
+
+      if (!ok)
+         return false;
+   }
+
+   return true;
+}
@@ -37,12 +37,57 @@ extern "C" {
 
 
 struct pipe_context;
+struct pipe_transfer;
+
+/**
+ * A mip level and the level above it, mapped by util_gen_mipmap_map_level().
+ */
+struct util_gen_mipmap_level {
+   enum pipe_format format;
+   bool is_3d;
+   struct pipe_transfer *src_trans, *dst_trans;
+   const uint8_t *src_map;
+   uint8_t *dst_map;
+   unsigned src_width, src_height, src_depth;
+   unsigned dst_width, dst_height, dst_depth;
+};
 
 extern boolean
 util_gen_mipmap(struct pipe_context *pipe, struct pipe_resource *pt,
                 enum pipe_format format, uint base_level, uint last_level,
                 uint first_layer, uint last_layer, uint filter);
 
+bool
+util_downsample_box_supported(enum pipe_format format);
+
+bool
+util_downsample_box(enum pipe_format format,
+                    uint8_t *dst, unsigned dst_stride, unsigned dst_width,
+                    unsigned dst_y0, unsigned dst_y1,
+                    const uint8_t *src0, const uint8_t *src1,
+                    unsigned src_stride, unsigned src_width,
+                    unsigned src_height);
+
+bool
+util_gen_mipmap_map_level(struct pipe_context *pipe, struct pipe_resource *pt,
+                          enum pipe_format format, unsigned level,
+                          unsigned first_layer, unsigned last_layer,
+                          struct util_gen_mipmap_level *lvl);
+
+void
+util_gen_mipmap_unmap_level(struct pipe_context *pipe,
+                            struct util_gen_mipmap_level *lvl);
+
+bool
+util_gen_mipmap_downsample_slice(const struct util_gen_mipmap_level *lvl,
+                                 unsigned z, unsigned dst_y0, unsigned dst_y1);
+
+bool
+util_gen_mipmap_cpu(struct pipe_context *pipe, struct pipe_resource *pt,
+                    enum pipe_format format, unsigned base_level,
+                    unsigned last_level, unsigned first_layer,
+                    unsigned last_layer);
+
 
 #ifdef __cplusplus
 }
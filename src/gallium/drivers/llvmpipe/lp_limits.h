@@ -54,6 +54,13 @@
 #define LP_MAX_TEXTURE_ARRAY_LAYERS 2048 /* 16K x 2048 / 16K x 16K x 2048 */
 
 
+/**
+ * Sampler-only texture row strides that are a multiple of this get padded
+ * by a cache line, so consecutive rows don't alias in the cpu caches.
+ */
+#define LP_TEXTURE_ALIAS_STRIDE 4096
+
+
 /** This must be the larger of LP_MAX_TEXTURE_2D/3D_LEVELS */
 #define LP_MAX_TEXTURE_LEVELS LP_MAX_TEXTURE_2D_LEVELS
 
@@ -311,6 +311,7 @@ lp_rast_shade_tile(struct lp_rasterizer_task *task,
    const struct lp_rast_state *state;
    struct lp_fragment_shader_variant *variant;
    const unsigned tile_x = task->x, tile_y = task->y;
+   const uint64_t mask = lp_rast_sample_mask(scene->fb_max_samples, 0xffff);
    unsigned x, y;
 
    if (inputs->disable) {
@@ -361,10 +362,6 @@ lp_rast_shade_tile(struct lp_rasterizer_task *task,
             depth_sample_stride = scene->zsbuf.sample_stride;
          }
 
-         uint64_t mask = 0;
-         for (unsigned i = 0; i < scene->fb_max_samples; i++)
-            mask |= (uint64_t)(0xffff) << (16 * i);
-
          /* Propagate non-interpolated raster state. */
          task->thread_data.raster_state.viewport_index = inputs->viewport_index;
 
@@ -502,9 +499,7 @@ lp_rast_shade_quads_mask(struct lp_rasterizer_task *task,
                          unsigned x, unsigned y,
                          unsigned mask)
 {
-   uint64_t new_mask = 0;
-   for (unsigned i = 0; i < task->scene->fb_max_samples; i++)
-      new_mask |= ((uint64_t)mask) << (16 * i);
+   uint64_t new_mask = lp_rast_sample_mask(task->scene->fb_max_samples, mask);
    lp_rast_shade_quads_mask_sample(task, inputs, x, y, new_mask);
 }
 
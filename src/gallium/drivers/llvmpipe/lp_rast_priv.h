@@ -143,6 +143,25 @@ lp_rast_shade_quads_mask(struct lp_rasterizer_task *task,
                          unsigned mask);
 
 
+/**
+ * Replicate a 16-bit 4x4 block coverage mask across all samples.
+ * The fragment shader takes one 64-bit mask with 16 bits per sample,
+ * which is what bounds LP_MAX_SAMPLES.
+ */
+static inline uint64_t
+lp_rast_sample_mask(unsigned nr_samples, unsigned mask)
+{
+   uint64_t sample_mask = 0;
+
+   STATIC_ASSERT(LP_MAX_SAMPLES * 16 <= 64);
+   assert(nr_samples <= LP_MAX_SAMPLES);
+
+   for (unsigned i = 0; i < nr_samples; i++)
+      sample_mask |= (uint64_t)(mask & 0xffff) << (16 * i);
+   return sample_mask;
+}
+
+
 /**
  * Get the pointer to a 4x4 color block (within a 64x64 tile).
  * \param x, y location of 4x4 block in window coords
@@ -261,9 +280,7 @@ lp_rast_shade_quads_all( struct lp_rasterizer_task *task,
       depth_stride = scene->zsbuf.stride;
    }
 
-   uint64_t mask = 0;
-   for (unsigned i = 0; i < scene->fb_max_samples; i++)
-      mask |= (uint64_t)0xffff << (16 * i);
+   uint64_t mask = lp_rast_sample_mask(scene->fb_max_samples, 0xffff);
 
    /*
     * The rasterizer may produce fragments outside our
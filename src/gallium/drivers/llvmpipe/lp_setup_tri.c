@@ -267,6 +267,47 @@ lp_setup_whole_tile(struct lp_setup_context *setup,
 }
 
 
+/**
+ * Check whether a tiny (at most 2x2 pixel bounding box) triangle may cover
+ * any of the pixel centers in its bounding box.
+ * This is only conservative: pixels lying exactly on an edge are treated
+ * as covered regardless of the fill convention, the rasterizer sorts those
+ * out. Only valid for single-sample rendering, where the sample point of
+ * pixel (x, y) is at (x, y) << FIXED_ORDER (the pixel offset has already
+ * been applied to the fixed point positions).
+ */
+static boolean
+tiny_triangle_may_cover_pixel(const struct fixed_position *position,
+                              const struct u_rect *bbox)
+{
+   int64_t dcdx[3], dcdy[3], c[3];
+   int x, y, i;
+
+   for (i = 0; i < 3; i++) {
+      int j = (i + 1) % 3;
+      dcdx[i] = position->y[i] - position->y[j];
+      dcdy[i] = position->x[i] - position->x[j];
+      c[i] = dcdx[i] * position->x[i] - dcdy[i] * position->y[i];
+   }
+
+   for (y = bbox->y0; y <= bbox->y1; y++) {
+      for (x = bbox->x0; x <= bbox->x1; x++) {
+         int64_t px = (int64_t)x << FIXED_ORDER;
+         int64_t py = (int64_t)y << FIXED_ORDER;
+
+         for (i = 0; i < 3; i++) {
+            if (c[i] + dcdy[i] * py - dcdx[i] * px < 0)
+               break;
+         }
+         if (i == 3)
+            return TRUE;
+      }
+   }
+
+   return FALSE;
+}
+
+
 /**
  * Do basic setup for triangle rasterization and determine which
  * framebuffer tiles are touched.  Put the triangle in the scene's
@@ -345,6 +386,20 @@ do_triangle_ccw(struct lp_setup_context *setup,
       return TRUE;
    }
 
+   /*
+    * Dense meshes produce lots of triangles smaller than a pixel which
+    * don't hit any pixel center. Reject those before running the setup
+    * jit function and allocating scene memory for them.
+    */
+   if (!setup->multisample &&
+       bbox.x1 - bbox.x0 <= 1 &&
+       bbox.y1 - bbox.y0 <= 1 &&
+       !tiny_triangle_may_cover_pixel(position, &bbox)) {
+      if (0) debug_printf("no pixel centers covered\n");
+      LP_COUNT(nr_culled_tris);
+      return TRUE;
+   }
+
    bboxpos = bbox;
 
    /* Can safely discard negative regions, but need to keep hold of
@@ -28,6 +28,8 @@
 #include "util/u_rect.h"
 #include "util/u_surface.h"
 #include "util/u_memset.h"
+#include "util/u_atomic.h"
+#include "util/u_gen_mipmap.h"
 #include "lp_context.h"
 #include "lp_flush.h"
 #include "lp_limits.h"
@@ -35,6 +37,134 @@
 #include "lp_texture.h"
 #include "lp_query.h"
 #include "lp_rast.h"
+#include "lp_screen.h"
+#include "lp_cs_tpool.h"
+
+/**
+ * Copies smaller than this are done on the calling thread, where the
+ * memcpy is cheaper than waking up the thread pool.
+ */
+#define LP_COPY_THREAD_MIN_BYTES (1024 * 1024)
+
+/** Roughly how many bytes one copy or mipmap task writes. */
+#define LP_COPY_TASK_BYTES (64 * 1024)
+
+struct lp_copy_job {
+   enum pipe_format format;
+   uint8_t *dst_map;
+   const uint8_t *src_map;
+   unsigned dst_stride, dst_layer_stride;
+   unsigned src_stride, src_layer_stride;
+   unsigned width, height;
+   unsigned rows_per_task; /* in pixels, a multiple of the block height */
+   unsigned tasks_per_layer;
+};
+
+static void
+lp_copy_task(void *data, int iter_idx, struct lp_cs_local_mem *lmem)
+{
+   const struct lp_copy_job *job = data;
+   unsigned layer = iter_idx / job->tasks_per_layer;
+   unsigned y = (iter_idx % job->tasks_per_layer) * job->rows_per_task;
+
+   util_copy_rect(job->dst_map + layer * job->dst_layer_stride,
+                  job->format, job->dst_stride,
+                  0, y,
+                  job->width, MIN2(job->rows_per_task, job->height - y),
+                  job->src_map + layer * job->src_layer_stride,
+                  job->src_stride,
+                  0, y);
+}
+
+/**
+ * Split a large texture copy into bands of rows and run them on the
+ * screen's thread pool.  Only handles copies between formats with the
+ * same block layout; everything else is left to
+ * util_resource_copy_region().
+ *
+ * \return  true if the copy was done
+ */
+static bool
+lp_resource_copy_threaded(struct pipe_context *pipe,
+                          struct pipe_resource *dst, unsigned dst_level,
+                          unsigned dstx, unsigned dsty, unsigned dstz,
+                          struct pipe_resource *src, unsigned src_level,
+                          const struct pipe_box *src_box)
+{
+   struct llvmpipe_screen *screen = llvmpipe_screen(pipe->screen);
+   const struct util_format_description *src_desc =
+      util_format_description(src->format);
+   const struct util_format_description *dst_desc =
+      util_format_description(dst->format);
+   struct pipe_transfer *src_trans, *dst_trans;
+   struct lp_cs_tpool_task *task;
+   struct lp_copy_job job;
+   bool copied;
+
+   if (screen->num_threads < 2)
+      return false;
+
+   if (src->target == PIPE_BUFFER || dst->target == PIPE_BUFFER)
+      return false;
+
+   if (src_desc->block.bits != dst_desc->block.bits ||
+       src_desc->block.width != dst_desc->block.width ||
+       src_desc->block.height != dst_desc->block.height)
+      return false;
+
+   const unsigned bw = src_desc->block.width;
+   const unsigned bh = src_desc->block.height;
+   const unsigned row_bytes =
+      DIV_ROUND_UP(src_box->width, bw) * (src_desc->block.bits / 8);
+   const unsigned block_rows = DIV_ROUND_UP(src_box->height, bh);
+
+   if ((uint64_t)row_bytes * block_rows * src_box->depth <
+       LP_COPY_THREAD_MIN_BYTES)
+      return false;
+
+   struct pipe_box dst_box = *src_box;
+   dst_box.x = dstx;
+   dst_box.y = dsty;
+   dst_box.z = dstz;
+
+   job.src_map = pipe->transfer_map(pipe, src, src_level, PIPE_MAP_READ,
+                                    src_box, &src_trans);
+   if (!job.src_map)
+      return false;
+
+   job.dst_map = pipe->transfer_map(pipe, dst, dst_level,
+                                    PIPE_MAP_WRITE | PIPE_MAP_DISCARD_RANGE,
+                                    &dst_box, &dst_trans);
+   if (!job.dst_map) {
+      pipe->transfer_unmap(pipe, src_trans);
+      return false;
+   }
+
+   job.format = src->format;
+   job.dst_stride = dst_trans->stride;
+   job.dst_layer_stride = dst_trans->layer_stride;
+   job.src_stride = src_trans->stride;
+   job.src_layer_stride = src_trans->layer_stride;
+   job.width = src_box->width;
+   job.height = src_box->height;
+   job.rows_per_task = MAX2(LP_COPY_TASK_BYTES / row_bytes, 1) * bh;
+   job.tasks_per_layer = DIV_ROUND_UP(job.height, job.rows_per_task);
+
+   mtx_lock(&screen->cs_mutex);
+   task = lp_cs_tpool_queue_task(screen->cs_tpool, lp_copy_task, &job,
+                                 job.tasks_per_layer * src_box->depth);
+   /* The pool has threads, so NULL means the task couldn't be allocated
+    * and nothing was copied.
+    */
+   copied = task != NULL;
+   lp_cs_tpool_wait_for_task(screen->cs_tpool, &task);
+   mtx_unlock(&screen->cs_mutex);
+
+   pipe->transfer_unmap(pipe, dst_trans);
+   pipe->transfer_unmap(pipe, src_trans);
+
+   return copied;
+}
 
 static void
 lp_resource_copy_ms(struct pipe_context *pipe,
@@ -108,6 +238,11 @@ lp_resource_copy(struct pipe_context *pipe,
                           src, src_level, src_box);
       return;
    }
+
+   if (lp_resource_copy_threaded(pipe, dst, dst_level, dstx, dsty, dstz,
+                                 src, src_level, src_box))
+      return;
+
    util_resource_copy_region(pipe, dst, dst_level, dstx, dsty, dstz,
                              src, src_level, src_box);
 }
@@ -173,6 +308,89 @@ static void lp_blit(struct pipe_context *pipe,
 }
 
 
+struct lp_mipmap_job {
+   struct util_gen_mipmap_level level;
+   unsigned rows_per_task;
+   unsigned tasks_per_layer;
+   int failed;
+};
+
+static void
+lp_mipmap_task(void *data, int iter_idx, struct lp_cs_local_mem *lmem)
+{
+   struct lp_mipmap_job *job = data;
+   unsigned z = iter_idx / job->tasks_per_layer;
+   unsigned y = (iter_idx % job->tasks_per_layer) * job->rows_per_task;
+
+   if (!util_gen_mipmap_downsample_slice(&job->level, z, y,
+                                         MIN2(y + job->rows_per_task,
+                                              job->level.dst_height)))
+      p_atomic_set(&job->failed, 1);
+}
+
+/**
+ * Called via pipe->generate_mipmap().  Each level is box filtered on the
+ * CPU, with the layers and bands of rows of a level spread over the
+ * screen's thread pool.  Formats util_downsample_box() can't handle
+ * return false, so the state tracker falls back to util_gen_mipmap().
+ */
+static bool
+lp_generate_mipmap(struct pipe_context *pipe,
+                   struct pipe_resource *pt,
+                   enum pipe_format format,
+                   unsigned base_level,
+                   unsigned last_level,
+                   unsigned first_layer,
+                   unsigned last_layer)
+{
+   struct llvmpipe_screen *screen = llvmpipe_screen(pipe->screen);
+   const unsigned bs = util_format_get_blocksize(format);
+
+   if (pt->target == PIPE_BUFFER || pt->nr_samples > 1 ||
+       !util_downsample_box_supported(format))
+      return false;
+
+   if (screen->num_threads < 2)
+      return util_gen_mipmap_cpu(pipe, pt, format, base_level, last_level,
+                                 first_layer, last_layer);
+
+   assert(last_level <= pt->last_level);
+
+   for (unsigned level = base_level + 1; level <= last_level; level++) {
+      struct lp_cs_tpool_task *task;
+      struct lp_mipmap_job job;
+
+      if (!util_gen_mipmap_map_level(pipe, pt, format, level,
+                                     first_layer, last_layer, &job.level))
+         return false;
+
+      job.rows_per_task = MAX2(LP_COPY_TASK_BYTES /
+                               (job.level.dst_width * bs), 1);
+      job.tasks_per_layer = DIV_ROUND_UP(job.level.dst_height,
+                                         job.rows_per_task);
+      job.failed = 0;
+
+      mtx_lock(&screen->cs_mutex);
+      task = lp_cs_tpool_queue_task(screen->cs_tpool, lp_mipmap_task, &job,
+                                    job.tasks_per_layer * job.level.dst_depth);
+      /* NULL means the task couldn't be allocated and the level is
+       * untouched.
+       */
+      if (!task)
+         job.failed = 1;
+      lp_cs_tpool_wait_for_task(screen->cs_tpool, &task);
+      mtx_unlock(&screen->cs_mutex);
+
+      util_gen_mipmap_unmap_level(pipe, &job.level);
+
+      if (p_atomic_read(&job.failed))
+         return false;
+   }
+
+   return true;
+}
+
+
 static void
 lp_flush_resource(struct pipe_context *ctx, struct pipe_resource *resource)
 {
@@ -491,5 +709,6 @@ llvmpipe_init_surface_functions(struct llvmpipe_context *lp)
    lp->pipe.resource_copy_region = lp_resource_copy;
    lp->pipe.blit = lp_blit;
    lp->pipe.flush_resource = lp_flush_resource;
+   lp->pipe.generate_mipmap = lp_generate_mipmap;
    lp->pipe.get_sample_position = llvmpipe_get_sample_position;
 }
@@ -125,6 +125,20 @@ llvmpipe_texture_layout(struct llvmpipe_screen *screen,
       else
          lpr->row_stride[level] = align(nblocksx * block_size, util_cpu_caps.cacheline);
 
+      /*
+       * Row strides which are a multiple of the page size make every row of
+       * an image land in the same cache sets, so vertical, rotated and
+       * minified sampler footprints keep evicting each other. Pad such
+       * strides by a cache line for textures which are only sampled from;
+       * render targets keep the plain layout the rasterizer tiles expect.
+       */
+      if (nblocksy > 1 &&
+          (pt->bind & PIPE_BIND_SAMPLER_VIEW) &&
+          !(pt->bind & (PIPE_BIND_RENDER_TARGET | PIPE_BIND_DEPTH_STENCIL)) &&
+          (lpr->row_stride[level] % LP_TEXTURE_ALIAS_STRIDE) == 0) {
+         lpr->row_stride[level] += mip_align;
+      }
+
       /* if row_stride * height > LP_MAX_TEXTURE_SIZE */
       if ((uint64_t)lpr->row_stride[level] * nblocksy > LP_MAX_TEXTURE_SIZE) {
          /* image too large */
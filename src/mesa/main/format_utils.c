@@ -30,6 +30,10 @@
 #include "format_pack.h"
 #include "format_unpack.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 const mesa_array_format RGBA32_FLOAT =
    MESA_ARRAY_FORMAT(MESA_ARRAY_FORMAT_BASE_FORMAT_RGBA_VARIANTS,
                      4, 1, 1, 1, 4, 0, 1, 2, 3);
@@ -821,6 +825,114 @@ swizzle_convert_try_memcpy(void *dst,
    return true;
 }
 
+/**
+ * Bit offset of the given channel inside a 32-bit word holding one
+ * 4 x ubyte pixel.
+ */
+static inline int
+ubyte4_channel_shift(int chan)
+{
+#if UTIL_ARCH_LITTLE_ENDIAN
+   return chan * 8;
+#else
+   return (3 - chan) * 8;
+#endif
+}
+
+/**
+ * Attempts to perform the given swizzle-and-convert operation on whole
+ * 32-bit pixels
+ *
+ * Any 4 x ubyte to 4 x ubyte swizzle is the same for normalized and
+ * unnormalized data, and every destination channel is either a source
+ * channel moved by a constant number of bits or a constant.  Sorting the
+ * source channels by how far they move gives a loop of fixed masks and
+ * shifts, which does four pixels at a time with SSE2 and is much cheaper
+ * than going through the per-channel tmp[] array of SWIZZLE_CONVERT.  This
+ * covers the common RGBA <-> BGRA, ARGB and RGBX -> RGBA uploads and
+ * readbacks.
+ *
+ * The arguments are exactly the same as for _mesa_swizzle_and_convert
+ *
+ * \return  true if it successfully performed the swizzle-and-convert
+ *          operation, false otherwise
+ */
+static bool
+swizzle_convert_try_ubyte4(void *dst,
+                           enum mesa_array_format_datatype dst_type,
+                           int num_dst_channels,
+                           const void *src,
+                           enum mesa_array_format_datatype src_type,
+                           int num_src_channels,
+                           const uint8_t swizzle[4], bool normalized, int count)
+{
+   const uint32_t one = normalized ? UINT8_MAX : 1;
+   /* masks[3 + n] selects the source bits which move left by n bytes */
+   uint32_t masks[7] = { 0 };
+   uint32_t constant = 0;
+   int i;
+
+   if (src_type != MESA_ARRAY_FORMAT_TYPE_UBYTE ||
+       dst_type != MESA_ARRAY_FORMAT_TYPE_UBYTE)
+      return false;
+   if (num_src_channels != 4 || num_dst_channels != 4)
+      return false;
+   if ((uintptr_t) src % 4 != 0 || (uintptr_t) dst % 4 != 0)
+      return false;
+
+   for (i = 0; i < 4; ++i) {
+      const int dst_shift = ubyte4_channel_shift(i);
+
+      if (swizzle[i] < 4) {
+         const int src_shift = ubyte4_channel_shift(swizzle[i]);
+         masks[3 + (dst_shift - src_shift) / 8] |= 0xffu << src_shift;
+      } else if (swizzle[i] == MESA_FORMAT_SWIZZLE_ONE) {
+         constant |= one << dst_shift;
+      }
+   }
+
+   const uint32_t *typed_src = src;
+   uint32_t *typed_dst = dst;
+   i = 0;
+
+#if defined(__SSE2__)
+   const __m128i vconstant = _mm_set1_epi32(constant);
+   const __m128i vmask0 = _mm_set1_epi32(masks[0]);
+   const __m128i vmask1 = _mm_set1_epi32(masks[1]);
+   const __m128i vmask2 = _mm_set1_epi32(masks[2]);
+   const __m128i vmask3 = _mm_set1_epi32(masks[3]);
+   const __m128i vmask4 = _mm_set1_epi32(masks[4]);
+   const __m128i vmask5 = _mm_set1_epi32(masks[5]);
+   const __m128i vmask6 = _mm_set1_epi32(masks[6]);
+
+   for (; i + 4 <= count; i += 4) {
+      const __m128i s = _mm_loadu_si128((const __m128i *) (typed_src + i));
+      __m128i d = _mm_or_si128(vconstant, _mm_and_si128(s, vmask3));
+      d = _mm_or_si128(d, _mm_srli_epi32(_mm_and_si128(s, vmask0), 24));
+      d = _mm_or_si128(d, _mm_srli_epi32(_mm_and_si128(s, vmask1), 16));
+      d = _mm_or_si128(d, _mm_srli_epi32(_mm_and_si128(s, vmask2), 8));
+      d = _mm_or_si128(d, _mm_slli_epi32(_mm_and_si128(s, vmask4), 8));
+      d = _mm_or_si128(d, _mm_slli_epi32(_mm_and_si128(s, vmask5), 16));
+      d = _mm_or_si128(d, _mm_slli_epi32(_mm_and_si128(s, vmask6), 24));
+      _mm_storeu_si128((__m128i *) (typed_dst + i), d);
+   }
+#endif
+
+   for (; i < count; ++i) {
+      const uint32_t s = typed_src[i];
+      typed_dst[i] = constant |
+                     ((s & masks[0]) >> 24) |
+                     ((s & masks[1]) >> 16) |
+                     ((s & masks[2]) >> 8) |
+                      (s & masks[3]) |
+                     ((s & masks[4]) << 8) |
+                     ((s & masks[5]) << 16) |
+                     ((s & masks[6]) << 24);
+   }
+
+   return true;
+}
+
 /**
  * Represents a single instance of the standard swizzle-and-convert loop
  *
@@ -1540,6 +1652,11 @@ _mesa_swizzle_and_convert(void *void_dst, enum mesa_array_format_datatype dst_ty
                                   swizzle, normalized, count))
       return;
 
+   if (swizzle_convert_try_ubyte4(void_dst, dst_type, num_dst_channels,
+                                  void_src, src_type, num_src_channels,
+                                  swizzle, normalized, count))
+      return;
+
    switch (dst_type) {
    case MESA_ARRAY_FORMAT_TYPE_FLOAT:
       convert_float(void_dst, num_dst_channels, void_src, src_type,
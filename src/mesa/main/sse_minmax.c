@@ -29,66 +29,99 @@
 #include <smmintrin.h>
 #include <stdint.h>
 
-void
-_mesa_uint_array_min_max(const unsigned *ui_indices, unsigned *min_index,
-                         unsigned *max_index, const unsigned count)
-{
-   unsigned max_ui = 0;
-   unsigned min_ui = ~0U;
-   unsigned i = 0;
-   unsigned aligned_count = count;
-
-   /* handle the first few values without SSE until the pointer is aligned */
-   while (((uintptr_t)ui_indices & 15) && aligned_count) {
-      if (*ui_indices > max_ui)
-         max_ui = *ui_indices;
-      if (*ui_indices < min_ui)
-         min_ui = *ui_indices;
-
-      aligned_count--;
-      ui_indices++;
-   }
-
-   /* TODO: The actual threshold for SSE begin useful may be higher than 8.
-    * Some careful microbenchmarks and measurement are required to
-    * find the actual tipping point.
-    */
-   if (aligned_count >= 8) {
-      unsigned max_arr[4] __attribute__ ((aligned (16)));
-      unsigned min_arr[4] __attribute__ ((aligned (16)));
-      unsigned vec_count;
-      __m128i max_ui4 = _mm_setzero_si128();
-      __m128i min_ui4 = _mm_set1_epi32(~0U);
-      __m128i ui_indices4;
-      __m128i *ui_indices_ptr;
-
-      vec_count = aligned_count & ~0x3;
-      ui_indices_ptr = (__m128i *)ui_indices;
-      for (i = 0; i < vec_count / 4; i++) {
-         ui_indices4 = _mm_load_si128(&ui_indices_ptr[i]);
-         max_ui4 = _mm_max_epu32(ui_indices4, max_ui4);
-         min_ui4 = _mm_min_epu32(ui_indices4, min_ui4);
-      }
-
-      _mm_store_si128((__m128i *)max_arr, max_ui4);
-      _mm_store_si128((__m128i *)min_arr, min_ui4);
-
-      for (i = 0; i < 4; i++) {
-         if (max_arr[i] > max_ui)
-            max_ui = max_arr[i];
-         if (min_arr[i] < min_ui)
-            min_ui = min_arr[i];
-      }
-      i = vec_count;
-   }
-
-   for (; i < aligned_count; i++) {
-      if (ui_indices[i] > max_ui)
-         max_ui = ui_indices[i];
-      if (ui_indices[i] < min_ui)
-         min_ui = ui_indices[i];
-   }
-
-   *min_index = min_ui;
-   *max_index = max_ui;
+/*
+ * Generates a min/max scan over an index array of type TYPE.  When
+ * restart is set, elements equal to restart_index are skipped: they are
+ * replaced by 0 for the max and by the type's maximum for the min, and
+ * has_index tracks whether the vector loop saw a real index at all so
+ * that an array of only restart indices still returns min = ~0, max = 0.
+ */
+#define SSE_MINMAX_FUNC(NAME, TYPE, LANES, SET1, CMPEQ, MIN, MAX)            \
+void                                                                         \
+NAME(const TYPE *indices, unsigned *min_index, unsigned *max_index,          \
+     const unsigned count, bool restart, unsigned restart_index)             \
+{                                                                            \
+   unsigned max_i = 0;                                                       \
+   unsigned min_i = ~0U;                                                     \
+   unsigned i = 0;                                                           \
+   unsigned aligned_count = count;                                           \
+                                                                             \
+   /* a restart index that doesn't fit in TYPE never matches */              \
+   if (restart_index != (TYPE)restart_index)                                 \
+      restart = false;                                                       \
+                                                                             \
+   /* handle the first few values without SSE until the pointer is aligned */\
+   while (((uintptr_t)indices & 15) && aligned_count) {                      \
+      if (!restart || *indices != restart_index) {                           \
+         if (*indices > max_i)                                               \
+            max_i = *indices;                                                \
+         if (*indices < min_i)                                               \
+            min_i = *indices;                                                \
+      }                                                                      \
+                                                                             \
+      aligned_count--;                                                       \
+      indices++;                                                             \
+   }                                                                         \
+                                                                             \
+   if (aligned_count >= 2 * LANES) {                                         \
+      TYPE max_arr[LANES] __attribute__ ((aligned (16)));                    \
+      TYPE min_arr[LANES] __attribute__ ((aligned (16)));                    \
+      unsigned vec_count = aligned_count & ~(LANES - 1);                     \
+      const __m128i *ptr = (const __m128i *)indices;                         \
+      __m128i max_v = _mm_setzero_si128();                                   \
+      __m128i min_v = _mm_set1_epi32(~0);                                    \
+      bool has_index = true;                                                 \
+                                                                             \
+      if (restart) {                                                         \
+         __m128i restart_v = SET1((TYPE)restart_index);                      \
+         __m128i all_restart = _mm_set1_epi32(~0);                           \
+                                                                             \
+         for (i = 0; i < vec_count / LANES; i++) {                           \
+            __m128i v = _mm_load_si128(&ptr[i]);                             \
+            __m128i is_restart = CMPEQ(v, restart_v);                        \
+            max_v = MAX(_mm_andnot_si128(is_restart, v), max_v);             \
+            min_v = MIN(_mm_or_si128(is_restart, v), min_v);                 \
+            all_restart = _mm_and_si128(all_restart, is_restart);            \
+         }                                                                   \
+                                                                             \
+         /* only restart indices: leave min alone so it stays ~0 */          \
+         has_index = _mm_movemask_epi8(all_restart) != 0xffff;               \
+      } else {                                                               \
+         for (i = 0; i < vec_count / LANES; i++) {                           \
+            __m128i v = _mm_load_si128(&ptr[i]);                             \
+            max_v = MAX(v, max_v);                                           \
+            min_v = MIN(v, min_v);                                           \
+         }                                                                   \
+      }                                                                      \
+                                                                             \
+      _mm_store_si128((__m128i *)max_arr, max_v);                            \
+      _mm_store_si128((__m128i *)min_arr, min_v);                            \
+                                                                             \
+      for (i = 0; i < LANES; i++) {                                          \
+         if (max_arr[i] > max_i)                                             \
+            max_i = max_arr[i];                                              \
+         if (has_index && min_arr[i] < min_i)                                \
+            min_i = min_arr[i];                                              \
+      }                                                                      \
+      i = vec_count;                                                         \
+   }                                                                         \
+                                                                             \
+   for (; i < aligned_count; i++) {                                          \
+      if (restart && indices[i] == restart_index)                            \
+         continue;                                                           \
+      if (indices[i] > max_i)                                                \
+         max_i = indices[i];                                                 \
+      if (indices[i] < min_i)                                                \
+         min_i = indices[i];                                                 \
+   }                                                                         \
+                                                                             \
+   *min_index = min_i;                                                       \
+   *max_index = max_i;                                                       \
 }
+
+SSE_MINMAX_FUNC(_mesa_uint_array_min_max, unsigned, 4, _mm_set1_epi32,
+                _mm_cmpeq_epi32, _mm_min_epu32, _mm_max_epu32)
+SSE_MINMAX_FUNC(_mesa_ushort_array_min_max, uint16_t, 8, _mm_set1_epi16,
+                _mm_cmpeq_epi16, _mm_min_epu16, _mm_max_epu16)
+SSE_MINMAX_FUNC(_mesa_ubyte_array_min_max, uint8_t, 16, _mm_set1_epi8,
+                _mm_cmpeq_epi8, _mm_min_epu8, _mm_max_epu8)
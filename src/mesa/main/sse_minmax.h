@@ -28,8 +28,25 @@
 #ifndef SSE_MINMAX_H
 #define SSE_MINMAX_H
 
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Elements equal to restart_index are skipped if restart is set.  An array
+ * containing only restart indices gives min = ~0, max = 0.
+ */
+void
+_mesa_uint_array_min_max(const unsigned *indices, unsigned *min_index,
+                         unsigned *max_index, const unsigned count,
+                         bool restart, unsigned restart_index);
+
+void
+_mesa_ushort_array_min_max(const uint16_t *indices, unsigned *min_index,
+                           unsigned *max_index, const unsigned count,
+                           bool restart, unsigned restart_index);
+
 void
-_mesa_uint_array_min_max(const unsigned *ui_indices, unsigned *min_index,
-                         unsigned *max_index, const unsigned count);
+_mesa_ubyte_array_min_max(const uint8_t *indices, unsigned *min_index,
+                          unsigned *max_index, const unsigned count,
+                          bool restart, unsigned restart_index);
 
 #endif /* SSE_MINMAX_H */
@@ -35,6 +35,7 @@
 
 #include "texcompress_astc.h"
 #include "macros.h"
+#include "c11/threads.h"
 #include "util/half_float.h"
 #include <stdio.h>
 #include <cstdlib>  // for abort() on windows
@@ -48,6 +49,21 @@ uint16_div_64k_to_half_to_unorm8(uint16_t v)
    return _mesa_half_to_unorm8(_mesa_uint16_div_64k_to_half(v));
 }
 
+/* The conversion above runs for every channel of every texel decoded to
+ * unorm8, and going through two out-of-line half-float conversions is a
+ * large part of the decode time.  There are only 64k inputs, so build a
+ * lookup table once.  Note that 65535 maps to 0xff.
+ */
+static uint8_t unorm16_to_unorm8_table[65536];
+static once_flag unorm16_to_unorm8_table_once = ONCE_FLAG_INIT;
+
+static void
+unorm16_to_unorm8_table_init(void)
+{
+   for (unsigned v = 0; v < ARRAY_SIZE(unorm16_to_unorm8_table); v++)
+      unorm16_to_unorm8_table[v] = uint16_div_64k_to_half_to_unorm8(v);
+}
+
 class decode_error
 {
 public:
@@ -544,7 +560,11 @@ class Decoder
 public:
    Decoder(int block_w, int block_h, int block_d, bool srgb, bool output_unorm8)
       : block_w(block_w), block_h(block_h), block_d(block_d), srgb(srgb),
-        output_unorm8(output_unorm8) {}
+        output_unorm8(output_unorm8)
+   {
+      if (output_unorm8)
+         call_once(&unorm16_to_unorm8_table_once, unorm16_to_unorm8_table_init);
+   }
 
    decode_error::type decode(const uint8_t *in, uint16_t *output) const;
 
@@ -1619,11 +1639,11 @@ void Block::write_decoded(const Decoder &decoder, uint16_t *output)
                output[idx*4+1] = void_extent_colour_g >> 8;
                output[idx*4+2] = void_extent_colour_b >> 8;
             } else {
-               output[idx*4+0] = uint16_div_64k_to_half_to_unorm8(void_extent_colour_r);
-               output[idx*4+1] = uint16_div_64k_to_half_to_unorm8(void_extent_colour_g);
-               output[idx*4+2] = uint16_div_64k_to_half_to_unorm8(void_extent_colour_b);
+               output[idx*4+0] = unorm16_to_unorm8_table[void_extent_colour_r];
+               output[idx*4+1] = unorm16_to_unorm8_table[void_extent_colour_g];
+               output[idx*4+2] = unorm16_to_unorm8_table[void_extent_colour_b];
             }
-            output[idx*4+3] = uint16_div_64k_to_half_to_unorm8(void_extent_colour_a);
+            output[idx*4+3] = unorm16_to_unorm8_table[void_extent_colour_a];
          } else {
             /* Store the color as FP16. */
             output[idx*4+0] = _mesa_uint16_div_64k_to_half(void_extent_colour_r);
@@ -1704,11 +1724,11 @@ void Block::write_decoded(const Decoder &decoder, uint16_t *output)
                   output[idx*4+1] = c[1] >> 8;
                   output[idx*4+2] = c[2] >> 8;
                } else {
-                  output[idx*4+0] = c[0] == 65535 ? 0xff : uint16_div_64k_to_half_to_unorm8(c[0]);
-                  output[idx*4+1] = c[1] == 65535 ? 0xff : uint16_div_64k_to_half_to_unorm8(c[1]);
-                  output[idx*4+2] = c[2] == 65535 ? 0xff : uint16_div_64k_to_half_to_unorm8(c[2]);
+                  output[idx*4+0] = unorm16_to_unorm8_table[c[0]];
+                  output[idx*4+1] = unorm16_to_unorm8_table[c[1]];
+                  output[idx*4+2] = unorm16_to_unorm8_table[c[2]];
                }
-               output[idx*4+3] = c[3] == 65535 ? 0xff : uint16_div_64k_to_half_to_unorm8(c[3]);
+               output[idx*4+3] = unorm16_to_unorm8_table[c[3]];
             } else {
                /* Store the color as FP16. */
                output[idx*4+0] = c[0] == 65535 ? FP16_ONE : _mesa_uint16_div_64k_to_half(c[0]);
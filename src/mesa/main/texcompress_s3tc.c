@@ -40,6 +40,115 @@
 #include "texstore.h"
 #include "format_unpack.h"
 #include "util/format_srgb.h"
+#include "util/u_cpu_detect.h"
+#include "util/u_queue.h"
+
+
+/** Images with fewer blocks than this are compressed on one thread. */
+#define DXTN_THREAD_MIN_BLOCKS 4096
+
+#define DXTN_MAX_THREADS 16
+
+struct dxtn_band {
+   GLint srccomps;
+   GLint width, height;
+   const GLubyte *pixels;
+   GLenum destFormat;
+   GLubyte *dst;
+   GLint dstRowStride;
+   struct util_queue_fence fence;
+};
+
+/**
+ * Worker threads shared by all contexts, created the first time a large
+ * image is compressed.  The calling thread encodes one band itself.
+ */
+static struct util_queue dxtn_queue;
+static once_flag dxtn_queue_once = ONCE_FLAG_INIT;
+
+static void
+dxtn_queue_init(void)
+{
+   const unsigned num_threads = MIN2(util_cpu_caps.nr_cpus,
+                                     DXTN_MAX_THREADS) - 1;
+
+   if (num_threads)
+      util_queue_init(&dxtn_queue, "dxtn", DXTN_MAX_THREADS, num_threads,
+                      UTIL_QUEUE_INIT_RESIZE_IF_FULL);
+}
+
+static void
+compress_dxtn_band(void *data, UNUSED int thread_index)
+{
+   struct dxtn_band *band = data;
+
+   tx_compress_dxtn(band->srccomps, band->width, band->height, band->pixels,
+                    band->destFormat, band->dst, band->dstRowStride);
+}
+
+/**
+ * tx_compress_dxtn() split into bands of block rows, one per CPU.  Every
+ * block is encoded on its own, so the result is the same as compressing
+ * the whole image on one thread.
+ */
+static void
+compress_dxtn(GLint srccomps, GLint width, GLint height,
+              const GLubyte *pixels, GLenum destFormat,
+              GLubyte *dst, GLint dstRowStride)
+{
+   const GLint block_rows = DIV_ROUND_UP(height, 4);
+   const GLint blocks = block_rows * DIV_ROUND_UP(width, 4);
+   const bool dxt1 = destFormat == GL_COMPRESSED_RGB_S3TC_DXT1_EXT ||
+                     destFormat == GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+   struct dxtn_band bands[DXTN_MAX_THREADS];
+   GLint num_bands, rows_per_band, block_row_stride, b;
+
+   if (blocks >= DXTN_THREAD_MIN_BLOCKS) {
+      util_cpu_detect();
+      call_once(&dxtn_queue_once, dxtn_queue_init);
+   }
+
+   if (blocks < DXTN_THREAD_MIN_BLOCKS ||
+       !util_queue_is_initialized(&dxtn_queue)) {
+      tx_compress_dxtn(srccomps, width, height, pixels, destFormat,
+                       dst, dstRowStride);
+      return;
+   }
+
+   num_bands = MIN2(dxtn_queue.num_threads + 1, block_rows);
+
+   /* Same rule as tx_compress_dxtn() for when dstRowStride is used. */
+   if (dstRowStride >= width * (dxt1 ? 2 : 4))
+      block_row_stride = dstRowStride;
+   else
+      block_row_stride = DIV_ROUND_UP(width, 4) * (dxt1 ? 8 : 16);
+
+   rows_per_band = DIV_ROUND_UP(block_rows, num_bands) * 4;
+
+   for (b = 0; b < num_bands && b * rows_per_band < height; b++) {
+      const GLint y = b * rows_per_band;
+
+      bands[b].srccomps = srccomps;
+      bands[b].width = width;
+      bands[b].height = MIN2(rows_per_band, height - y);
+      bands[b].pixels = pixels + y * width * srccomps;
+      bands[b].destFormat = destFormat;
+      bands[b].dst = dst + (y / 4) * block_row_stride;
+      bands[b].dstRowStride = dstRowStride;
+
+      if (b) {
+         util_queue_fence_init(&bands[b].fence);
+         util_queue_add_job(&dxtn_queue, &bands[b], &bands[b].fence,
+                            compress_dxtn_band, NULL, 0);
+      }
+   }
+
+   compress_dxtn_band(&bands[0], 0);
+   for (GLint i = 1; i < b; i++) {
+      util_queue_fence_wait(&bands[i].fence);
+      util_queue_fence_destroy(&bands[i].fence);
+   }
+}
 
 
 /**
@@ -84,9 +193,9 @@ _mesa_texstore_rgb_dxt1(TEXSTORE_PARAMS)
 
    dst = dstSlices[0];
 
-   tx_compress_dxtn(3, srcWidth, srcHeight, pixels,
-                    GL_COMPRESSED_RGB_S3TC_DXT1_EXT,
-                    dst, dstRowStride);
+   compress_dxtn(3, srcWidth, srcHeight, pixels,
+                 GL_COMPRESSED_RGB_S3TC_DXT1_EXT,
+                 dst, dstRowStride);
 
    free((void *) tempImage);
 
@@ -140,9 +249,9 @@ _mesa_texstore_rgba_dxt1(TEXSTORE_PARAMS)
 
    dst = dstSlices[0];
 
-   tx_compress_dxtn(4, srcWidth, srcHeight, pixels,
-                    GL_COMPRESSED_RGBA_S3TC_DXT1_EXT,
-                    dst, dstRowStride);
+   compress_dxtn(4, srcWidth, srcHeight, pixels,
+                 GL_COMPRESSED_RGBA_S3TC_DXT1_EXT,
+                 dst, dstRowStride);
 
    free((void*) tempImage);
 
@@ -195,9 +304,9 @@ _mesa_texstore_rgba_dxt3(TEXSTORE_PARAMS)
 
    dst = dstSlices[0];
 
-   tx_compress_dxtn(4, srcWidth, srcHeight, pixels,
-                    GL_COMPRESSED_RGBA_S3TC_DXT3_EXT,
-                    dst, dstRowStride);
+   compress_dxtn(4, srcWidth, srcHeight, pixels,
+                 GL_COMPRESSED_RGBA_S3TC_DXT3_EXT,
+                 dst, dstRowStride);
 
    free((void *) tempImage);
 
@@ -250,9 +359,9 @@ _mesa_texstore_rgba_dxt5(TEXSTORE_PARAMS)
 
    dst = dstSlices[0];
 
-   tx_compress_dxtn(4, srcWidth, srcHeight, pixels,
-                    GL_COMPRESSED_RGBA_S3TC_DXT5_EXT,
-                    dst, dstRowStride);
+   compress_dxtn(4, srcWidth, srcHeight, pixels,
+                 GL_COMPRESSED_RGBA_S3TC_DXT5_EXT,
+                 dst, dstRowStride);
 
    free((void *) tempImage);
 
@@ -185,6 +185,18 @@ static void fetch_2d_texel_rgba_dxt5(GLint srcRowStride, const GLubyte *pixdata,
 
 #define ALPHACUT 127
 
+/* Weighted distance between a source pixel and a palette color.  Kept
+ * branch-free and separate from picking the minimum, so the palette
+ * searches below compile to straight-line code instead of a chain of
+ * unpredictable branches per pixel. */
+static inline GLuint colorerror( const GLubyte *src, const GLubyte *cv )
+{
+   const GLint dr = src[0] - cv[0];
+   const GLint dg = src[1] - cv[1];
+   const GLint db = src[2] - cv[2];
+   return dr * dr * REDWEIGHT + dg * dg * GREENWEIGHT + db * db * BLUEWEIGHT;
+}
+
 static void fancybasecolorsearch( UNUSED GLubyte *blkaddr, GLubyte srccolors[4][4][4], GLubyte *bestcolor[2],
                            GLint numxpixels, GLint numypixels, UNUSED GLint type, UNUSED GLboolean haveAlpha)
 {
@@ -194,8 +206,8 @@ static void fancybasecolorsearch( UNUSED GLubyte *blkaddr, GLubyte srccolors[4][
       if it's rgba_dxt1 and we have alpha in the block, currently even values which will be mapped to black
       due to their alpha value will influence the result */
    GLint i, j, colors, z;
-   GLuint pixerror, pixerrorred, pixerrorgreen, pixerrorblue, pixerrorbest;
-   GLint colordist, blockerrlin[2][3];
+   GLuint pixerror, pixerrorbest;
+   GLint blockerrlin[2][3];
    GLubyte nrcolor[2];
    GLint pixerrorcolorbest[3] = {0};
    GLubyte enc = 0;
@@ -241,57 +253,25 @@ static void fancybasecolorsearch( UNUSED GLubyte *blkaddr, GLubyte srccolors[4][
 
    for (j = 0; j < numypixels; j++) {
       for (i = 0; i < numxpixels; i++) {
-         pixerrorbest = 0xffffffff;
-         for (colors = 0; colors < 4; colors++) {
-            colordist = srccolors[j][i][0] - (cv[colors][0]);
-            pixerror = colordist * colordist * REDWEIGHT;
-            pixerrorred = colordist;
-            colordist = srccolors[j][i][1] - (cv[colors][1]);
-            pixerror += colordist * colordist * GREENWEIGHT;
-            pixerrorgreen = colordist;
-            colordist = srccolors[j][i][2] - (cv[colors][2]);
-            pixerror += colordist * colordist * BLUEWEIGHT;
-            pixerrorblue = colordist;
-            if (pixerror < pixerrorbest) {
-               enc = colors;
-               pixerrorbest = pixerror;
-               pixerrorcolorbest[0] = pixerrorred;
-               pixerrorcolorbest[1] = pixerrorgreen;
-               pixerrorcolorbest[2] = pixerrorblue;
-            }
-         }
-         if (enc == 0) {
-            for (z = 0; z < 3; z++) {
-               blockerrlin[0][z] += 3 * pixerrorcolorbest[z];
-            }
-            nrcolor[0] += 3;
-         }
-         else if (enc == 2) {
-            for (z = 0; z < 3; z++) {
-               blockerrlin[0][z] += 2 * pixerrorcolorbest[z];
-            }
-            nrcolor[0] += 2;
-            for (z = 0; z < 3; z++) {
-               blockerrlin[1][z] += 1 * pixerrorcolorbest[z];
-            }
-            nrcolor[1] += 1;
-         }
-         else if (enc == 3) {
-            for (z = 0; z < 3; z++) {
-               blockerrlin[0][z] += 1 * pixerrorcolorbest[z];
-            }
-            nrcolor[0] += 1;
-            for (z = 0; z < 3; z++) {
-               blockerrlin[1][z] += 2 * pixerrorcolorbest[z];
-            }
-            nrcolor[1] += 2;
-         }
-         else if (enc == 1) {
-            for (z = 0; z < 3; z++) {
-               blockerrlin[1][z] += 3 * pixerrorcolorbest[z];
-            }
-            nrcolor[1] += 3;
-         }
+         /* how much each palette entry pulls on base color 0 and 1 */
+         static const GLubyte weight0[4] = { 3, 0, 2, 1 };
+         static const GLubyte weight1[4] = { 0, 3, 1, 2 };
+         const GLubyte *src = srccolors[j][i];
+
+         enc = 0;
+         pixerrorbest = colorerror(src, cv[0]);
+         for (colors = 1; colors < 4; colors++) {
+            pixerror = colorerror(src, cv[colors]);
+            enc = pixerror < pixerrorbest ? colors : enc;
+            pixerrorbest = pixerror < pixerrorbest ? pixerror : pixerrorbest;
+         }
+         for (z = 0; z < 3; z++) {
+            pixerrorcolorbest[z] = src[z] - cv[enc][z];
+            blockerrlin[0][z] += weight0[enc] * pixerrorcolorbest[z];
+            blockerrlin[1][z] += weight1[enc] * pixerrorcolorbest[z];
+         }
+         nrcolor[0] += weight0[enc];
+         nrcolor[1] += weight1[enc];
       }
    }
    if (nrcolor[0] == 0) nrcolor[0] = 1;
@@ -384,7 +364,6 @@ static void storedxtencodedblock( GLubyte *blkaddr, GLubyte srccolors[4][4][4],
 
    GLint i, j, colors;
    GLuint testerror, testerror2, pixerror, pixerrorbest;
-   GLint colordist;
    GLushort color0, color1, tempcolor;
    GLuint bits = 0, bits2 = 0;
    GLubyte *colorptr;
@@ -416,18 +395,12 @@ static void storedxtencodedblock( GLubyte *blkaddr, GLubyte srccolors[4][4][4],
    testerror = 0;
    for (j = 0; j < numypixels; j++) {
       for (i = 0; i < numxpixels; i++) {
-         pixerrorbest = 0xffffffff;
-         for (colors = 0; colors < 4; colors++) {
-            colordist = srccolors[j][i][0] - cv[colors][0];
-            pixerror = colordist * colordist * REDWEIGHT;
-            colordist = srccolors[j][i][1] - cv[colors][1];
-            pixerror += colordist * colordist * GREENWEIGHT;
-            colordist = srccolors[j][i][2] - cv[colors][2];
-            pixerror += colordist * colordist * BLUEWEIGHT;
-            if (pixerror < pixerrorbest) {
-               pixerrorbest = pixerror;
-               enc = colors;
-            }
+         enc = 0;
+         pixerrorbest = colorerror(srccolors[j][i], cv[0]);
+         for (colors = 1; colors < 4; colors++) {
+            pixerror = colorerror(srccolors[j][i], cv[colors]);
+            enc = pixerror < pixerrorbest ? colors : enc;
+            pixerrorbest = pixerror < pixerrorbest ? pixerror : pixerrorbest;
          }
          testerror += pixerrorbest;
          bits |= (uint32_t)enc << (2 * (j * 4 + i));
@@ -454,19 +427,13 @@ static void storedxtencodedblock( GLubyte *blkaddr, GLubyte srccolors[4][4][4],
             }
             else {
                /* we're calculating the same what we have done already for colors 0-1 above... */
-               for (colors = 0; colors < 3; colors++) {
-                  colordist = srccolors[j][i][0] - cv[colors][0];
-                  pixerror = colordist * colordist * REDWEIGHT;
-                  colordist = srccolors[j][i][1] - cv[colors][1];
-                  pixerror += colordist * colordist * GREENWEIGHT;
-                  colordist = srccolors[j][i][2] - cv[colors][2];
-                  pixerror += colordist * colordist * BLUEWEIGHT;
-                  if (pixerror < pixerrorbest) {
-                     pixerrorbest = pixerror;
-                     /* need to exchange colors later */
-                     if (colors > 1) enc = colors;
-                     else enc = colors ^ 1;
-                  }
+               /* need to exchange colors 0 and 1 later */
+               enc = 1;
+               pixerrorbest = colorerror(srccolors[j][i], cv[0]);
+               for (colors = 1; colors < 3; colors++) {
+                  pixerror = colorerror(srccolors[j][i], cv[colors]);
+                  enc = pixerror < pixerrorbest ? (colors > 1 ? colors : 0) : enc;
+                  pixerrorbest = pixerror < pixerrorbest ? pixerror : pixerrorbest;
                }
             }
             testerror2 += pixerrorbest;
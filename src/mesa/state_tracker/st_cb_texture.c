@@ -1513,21 +1513,34 @@ st_TexSubImage(struct gl_context *ctx, GLuint dims,
    if (!dst)
       goto fallback;
 
-   /* Try texture_subdata, which should be the fastest memcpy path. */
-   if (pixels &&
-       !unpack->BufferObj &&
+   /* Try texture_subdata, which should be the fastest memcpy path.
+    *
+    * With an unpack PBO, only do this when the driver doesn't prefer blits
+    * for texture transfers: the buffer then lives in CPU memory as well, so
+    * mapping it and handing the pointer to texture_subdata is a single
+    * strided copy, without going through texstore.
+    */
+   if ((unpack->BufferObj ? !st->prefer_blit_based_texture_transfer
+                          : pixels != NULL) &&
        _mesa_texstore_can_use_memcpy(ctx, texImage->_BaseFormat,
                                      texImage->TexFormat, format, type,
                                      unpack)) {
       struct pipe_box box;
       unsigned stride, layer_stride;
+      const void *src_pixels;
       void *data;
 
+      src_pixels = _mesa_validate_pbo_teximage(ctx, dims, width, height,
+                                               depth, format, type, pixels,
+                                               unpack, "glTexSubImage");
+      if (!src_pixels)
+         return;
+
       stride = _mesa_image_row_stride(unpack, width, format, type);
       layer_stride = _mesa_image_image_stride(unpack, width, height, format,
                                               type);
-      data = _mesa_image_address(dims, unpack, pixels, width, height, format,
-                                 type, 0, 0, 0);
+      data = _mesa_image_address(dims, unpack, src_pixels, width, height,
+                                 format, type, 0, 0, 0);
 
       /* Convert to Gallium coordinates. */
       if (gl_target == GL_TEXTURE_1D_ARRAY) {
@@ -1545,6 +1558,7 @@ st_TexSubImage(struct gl_context *ctx, GLuint dims,
       u_box_3d(xoffset, yoffset, zoffset + dstz, width, height, depth, &box);
       pipe->texture_subdata(pipe, dst, dst_level, 0,
                             &box, data, stride, layer_stride);
+      _mesa_unmap_teximage_pbo(ctx, unpack);
       return;
    }
 
@@ -565,6 +565,114 @@ util_format_fits_8unorm(const struct util_format_description *format_desc)
 }
 
 
+/**
+ * Whether the format stores four 8-bit UNORM (or padding) channels in a
+ * 32-bit word, like RGBA8, BGRA8 or RGBX8.
+ */
+static boolean
+util_format_is_unorm8888(const struct util_format_description *desc)
+{
+   if (desc->layout != UTIL_FORMAT_LAYOUT_PLAIN ||
+       !desc->is_bitmask ||
+       desc->block.bits != 32 ||
+       desc->nr_channels != 4)
+      return FALSE;
+
+   for (unsigned i = 0; i < 4; i++) {
+      if (desc->channel[i].size != 8)
+         return FALSE;
+      if (desc->channel[i].type != UTIL_FORMAT_TYPE_VOID &&
+          (desc->channel[i].type != UTIL_FORMAT_TYPE_UNSIGNED ||
+           !desc->channel[i].normalized))
+         return FALSE;
+   }
+
+   return TRUE;
+}
+
+
+/**
+ * Translate between two util_format_is_unorm8888() formats whose channels
+ * are either in the same place or have R and B swapped (RGBA8 <-> BGRA8,
+ * RGBX8 -> RGBA8, ...), working on whole pixels instead of going through an
+ * RGBA8 temporary.  Gives the same result as the generic unpack/pack path.
+ *
+ * Returns FALSE for any other channel order.
+ */
+static boolean
+util_format_translate_unorm8888(const struct util_format_description *dst_desc,
+                                uint8_t *dst_row, unsigned dst_stride,
+                                const struct util_format_description *src_desc,
+                                const uint8_t *src_row, unsigned src_stride,
+                                unsigned width, unsigned height)
+{
+   uint32_t keep = 0;
+   uint32_t constant = 0;
+   boolean identity = TRUE;
+   boolean swap_rb = TRUE;
+
+   /* Shifts are in terms of the 32-bit pixel word, so this works the same
+    * on either endianness.
+    */
+   for (unsigned i = 0; i < 4; i++) {
+      const struct util_format_channel_description *channel =
+         &dst_desc->channel[i];
+
+      if (channel->type == UTIL_FORMAT_TYPE_VOID)
+         continue;
+
+      /* Find the RGBA component stored in this channel, if any. */
+      unsigned c;
+      for (c = 0; c < 4; c++) {
+         if (dst_desc->swizzle[c] == i)
+            break;
+      }
+      if (c == 4)
+         continue;
+
+      enum pipe_swizzle swizzle = src_desc->swizzle[c];
+      if (swizzle <= PIPE_SWIZZLE_W &&
+          src_desc->channel[swizzle].type != UTIL_FORMAT_TYPE_VOID) {
+         unsigned src_shift = src_desc->channel[swizzle].shift;
+         unsigned dst_shift = channel->shift;
+
+         keep |= 0xffu << dst_shift;
+         identity &= src_shift == dst_shift;
+         swap_rb &= src_shift == (dst_shift == 0 ? 16 :
+                                  dst_shift == 16 ? 0 : dst_shift);
+      } else if (swizzle == PIPE_SWIZZLE_1) {
+         constant |= 0xffu << channel->shift;
+      }
+   }
+
+   if (!identity && !swap_rb)
+      return FALSE;
+
+   while (height--) {
+      const uint32_t *src = (const uint32_t *)src_row;
+      uint32_t *dst = (uint32_t *)dst_row;
+
+      if (identity) {
+         for (unsigned x = 0; x < width; x++)
+            dst[x] = (src[x] & keep) | constant;
+      } else {
+         for (unsigned x = 0; x < width; x++) {
+            uint32_t value = src[x];
+            value = (value & 0xff00ff00) |
+                    ((value >> 16) & 0xff) |
+                    ((value & 0xff) << 16);
+            dst[x] = (value & keep) | constant;
+         }
+      }
+
+      src_row += src_stride;
+      dst_row += dst_stride;
+   }
+
+   return TRUE;
+}
+
+
 boolean
 util_format_translate(enum pipe_format dst_format,
                       void *dst, unsigned dst_stride,
@@ -621,9 +729,16 @@ util_format_translate(enum pipe_format dst_format,
    dst_step = y_step / dst_format_desc->block.height * dst_stride;
    src_step = y_step / src_format_desc->block.height * src_stride;
 
+   if (util_format_is_unorm8888(src_format_desc) &&
+       util_format_is_unorm8888(dst_format_desc) &&
+       src_format_desc->colorspace == dst_format_desc->colorspace &&
+       util_format_translate_unorm8888(dst_format_desc, dst_row, dst_stride,
+                                       src_format_desc, src_row, src_stride,
+                                       width, height))
+      return TRUE;
+
    /*
     * TODO: double formats will loose precision
-    * TODO: Add a special case for formats that are mere swizzles of each other
     */
 
    if (src_format_desc->colorspace == UTIL_FORMAT_COLORSPACE_ZS ||
@@ -618,6 +618,182 @@ def generate_pack_kernel(format, src_channel, src_native_type):
         print_channels(format, pack_into_struct)
 
 
+def is_unorm8x4_format(format):
+    '''Whether the format is four 8-bit UNORM (or padding) channels in a 32-bit
+    word, which the SSE2 row kernels below handle.'''
+    if format.layout != PLAIN or format.colorspace != RGB:
+        return False
+    if not format.is_bitmask() or format.block_size() != 32:
+        return False
+    for channel in format.le_channels:
+        if channel.size != 8:
+            return False
+        if channel.type != VOID and not (channel.type == UNSIGNED and channel.norm):
+            return False
+    return True
+
+
+def sse2_swizzle(swizzles, value):
+    '''Print code that swizzles the channels of an __m128 in place.  Channels
+    that aren't sourced from the input (None, SWIZZLE_0, SWIZZLE_NONE) are set
+    to 0.0 and SWIZZLE_1 channels to 1.0.'''
+    indices = [swizzle if swizzle is not None and swizzle < 4 else 0
+               for swizzle in swizzles]
+    if indices != [0, 1, 2, 3]:
+        print('            %s = _mm_shuffle_ps(%s, %s, _MM_SHUFFLE(%u, %u, %u, %u));' %
+              (value, value, value, indices[3], indices[2], indices[1], indices[0]))
+
+    keep = ['-1' if swizzle is not None and swizzle < 4 else '0'
+            for swizzle in swizzles]
+    ones = ['1.0f' if swizzle == SWIZZLE_1 else '0.0f' for swizzle in swizzles]
+    if '0' in keep:
+        print('            %s = _mm_and_ps(%s, _mm_castsi128_ps(_mm_setr_epi32(%s)));' %
+              (value, value, ', '.join(keep)))
+    if '1.0f' in ones:
+        print('            %s = _mm_or_ps(%s, _mm_setr_ps(%s));' %
+              (value, value, ', '.join(ones)))
+
+
+def generate_unorm8x4_unpack_float_sse2(format):
+    '''Print an SSE2 loop unpacking four pixels per iteration to float.  It
+    matches the scalar ubyte_to_float() exactly.'''
+    print('#if defined(PIPE_ARCH_SSE)')
+    print('      for(; x + 4 <= width; x += 4) {')
+    print('         const __m128i zero = _mm_setzero_si128();')
+    print('         const __m128 scale = _mm_set1_ps(1.0f / 255.0f);')
+    print('         __m128i pixels = _mm_loadu_si128((const __m128i *)src);')
+    print('         __m128i lo = _mm_unpacklo_epi8(pixels, zero);')
+    print('         __m128i hi = _mm_unpackhi_epi8(pixels, zero);')
+    print('         __m128i words[4] = {')
+    print('            _mm_unpacklo_epi16(lo, zero), _mm_unpackhi_epi16(lo, zero),')
+    print('            _mm_unpacklo_epi16(hi, zero), _mm_unpackhi_epi16(hi, zero),')
+    print('         };')
+    print('         for(unsigned i = 0; i < 4; i++) {')
+    print('            __m128 rgba = _mm_mul_ps(_mm_cvtepi32_ps(words[i]), scale);')
+    sse2_swizzle(format.le_swizzles, 'rgba')
+    print('            _mm_storeu_ps(dst + 4 * i, rgba);')
+    print('         }')
+    print('         src += 16;')
+    print('         dst += 16;')
+    print('      }')
+    print('#endif')
+
+
+def generate_unorm8x4_pack_float_sse2(format):
+    '''Print an SSE2 loop packing four pixels per iteration from float.  It
+    matches the scalar float_to_ubyte() exactly, including mapping NaN to 0.'''
+    print('#if defined(PIPE_ARCH_SSE)')
+    print('      for(; x + 4 <= width; x += 4) {')
+    print('         const __m128 zero = _mm_setzero_ps();')
+    print('         const __m128 one = _mm_set1_ps(1.0f);')
+    print('         const __m128 scale = _mm_set1_ps(255.0f / 256.0f);')
+    print('         const __m128 bias = _mm_set1_ps(32768.0f);')
+    print('         const __m128i mask = _mm_set1_epi32(0xff);')
+    print('         __m128i words[4];')
+    print('         for(unsigned i = 0; i < 4; i++) {')
+    print('            __m128 rgba = _mm_loadu_ps(src + 4 * i);')
+    sse2_swizzle(inv_swizzles(format.le_swizzles), 'rgba')
+    print('            /* maxps returns the second operand for NaN. */')
+    print('            rgba = _mm_min_ps(_mm_max_ps(rgba, zero), one);')
+    print('            rgba = _mm_add_ps(_mm_mul_ps(rgba, scale), bias);')
+    print('            words[i] = _mm_and_si128(_mm_castps_si128(rgba), mask);')
+    print('         }')
+    print('         __m128i lo = _mm_packs_epi32(words[0], words[1]);')
+    print('         __m128i hi = _mm_packs_epi32(words[2], words[3]);')
+    print('         _mm_storeu_si128((__m128i *)dst, _mm_packus_epi16(lo, hi));')
+    print('         src += 16;')
+    print('         dst += 16;')
+    print('      }')
+    print('#endif')
+
+
+def is_unorm32_format(format):
+    '''Whether the format is UNORM (or padding) channels of up to 16 bits in a
+    32-bit word, other than the 4 x 8-bit ones, e.g. R10G10B10A2.'''
+    if format.layout != PLAIN or format.colorspace != RGB:
+        return False
+    if not format.is_bitmask() or format.block_size() != 32:
+        return False
+    if is_unorm8x4_format(format):
+        return False
+    for channel in format.le_channels:
+        if channel.type == VOID:
+            continue
+        if channel.type != UNSIGNED or not channel.norm:
+            return False
+        # 8-bit channels go through ubyte_to_float()/float_to_ubyte()
+        if channel.size == 8 or channel.size > 16:
+            return False
+    return True
+
+
+def generate_unorm32_unpack_float_sse2(format):
+    '''Print an SSE2 loop unpacking four pixels of a is_unorm32_format() format
+    per iteration.  Each channel is extracted for all four pixels at once and
+    the result transposed, matching the scalar (float)(c * (1.0f/mask)).'''
+    print('#if defined(PIPE_ARCH_SSE)')
+    print('      for(; x + 4 <= width; x += 4) {')
+    print('         __m128i pixels = _mm_loadu_si128((const __m128i *)src);')
+    print('         __m128 c[4];')
+    for i in range(4):
+        channel = format.le_channels[i] if i < len(format.le_channels) else None
+        if channel is None or channel.type == VOID:
+            print('         c[%u] = _mm_setzero_ps();' % i)
+            continue
+        mask = (1 << channel.size) - 1
+        value = 'pixels'
+        if channel.shift:
+            value = '_mm_srli_epi32(%s, %u)' % (value, channel.shift)
+        if channel.shift + channel.size < 32:
+            value = '_mm_and_si128(%s, _mm_set1_epi32(0x%x))' % (value, mask)
+        print('         c[%u] = _mm_mul_ps(_mm_cvtepi32_ps(%s),' % (i, value))
+        print('                          _mm_set1_ps(1.0f/0x%x));' % mask)
+    print('         _MM_TRANSPOSE4_PS(c[0], c[1], c[2], c[3]);')
+    print('         for(unsigned i = 0; i < 4; i++) {')
+    print('            __m128 rgba = c[i];')
+    sse2_swizzle(format.le_swizzles, 'rgba')
+    print('            _mm_storeu_ps(dst + 4 * i, rgba);')
+    print('         }')
+    print('         src += 16;')
+    print('         dst += 16;')
+    print('      }')
+    print('#endif')
+
+
+def generate_unorm32_pack_float_sse2(format):
+    '''Print an SSE2 loop packing four pixels of a is_unorm32_format() format
+    per iteration, matching util_iround(CLAMP(c, 0.0f, 1.0f) * mask).  On
+    32-bit x86 util_iround() uses fistp instead of adding 0.5 and
+    truncating, so the loop is only emitted for x86-64.'''
+    print('#if defined(PIPE_ARCH_SSE) && !defined(PIPE_ARCH_X86)')
+    print('      for(; x + 4 <= width; x += 4) {')
+    print('         const __m128 zero = _mm_setzero_ps();')
+    print('         const __m128 one = _mm_set1_ps(1.0f);')
+    print('         const __m128 half = _mm_set1_ps(0.5f);')
+    print('         __m128i value = _mm_setzero_si128();')
+    print('         __m128 c[4];')
+    print('         for(unsigned i = 0; i < 4; i++) {')
+    print('            __m128 rgba = _mm_loadu_ps(src + 4 * i);')
+    sse2_swizzle(inv_swizzles(format.le_swizzles), 'rgba')
+    print('            /* maxps returns the second operand for NaN. */')
+    print('            c[i] = _mm_min_ps(_mm_max_ps(rgba, zero), one);')
+    print('         }')
+    print('         _MM_TRANSPOSE4_PS(c[0], c[1], c[2], c[3]);')
+    for i, channel in enumerate(format.le_channels):
+        if channel.type == VOID:
+            continue
+        mask = (1 << channel.size) - 1
+        channel_value = '_mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(c[%u], _mm_set1_ps(0x%x)), half))' % (i, mask)
+        if channel.shift:
+            channel_value = '_mm_slli_epi32(%s, %u)' % (channel_value, channel.shift)
+        print('         value = _mm_or_si128(value, %s);' % channel_value)
+    print('         _mm_storeu_si128((__m128i *)dst, value);')
+    print('         src += 16;')
+    print('         dst += 16;')
+    print('      }')
+    print('#endif')
+
+
 def generate_format_unpack(format, dst_channel, dst_native_type, dst_suffix):
     '''Generate the function to unpack pixels from a particular format'''
 
@@ -640,7 +816,16 @@ def generate_format_unpack(format, dst_channel, dst_native_type, dst_suffix):
         print('   for(y = 0; y < height; y += %u) {' % (format.block_height,))
         print('      %s *dst = dst_row;' % (dst_native_type))
         print('      const uint8_t *src = src_row;')
-        print('      for(x = 0; x < width; x += %u) {' % (format.block_width,))
+        if dst_suffix == 'rgba_float' and is_unorm8x4_format(format):
+            print('      x = 0;')
+            generate_unorm8x4_unpack_float_sse2(format)
+            print('      for(; x < width; x += 1) {')
+        elif dst_suffix == 'rgba_float' and is_unorm32_format(format):
+            print('      x = 0;')
+            generate_unorm32_unpack_float_sse2(format)
+            print('      for(; x < width; x += 1) {')
+        else:
+            print('      for(x = 0; x < width; x += %u) {' % (format.block_width,))
         
         generate_unpack_kernel(format, dst_channel, dst_native_type)
     
@@ -671,7 +856,16 @@ def generate_format_pack(format, src_channel, src_native_type, src_suffix):
         print('   for(y = 0; y < height; y += %u) {' % (format.block_height,))
         print('      const %s *src = src_row;' % (src_native_type))
         print('      uint8_t *dst = dst_row;')
-        print('      for(x = 0; x < width; x += %u) {' % (format.block_width,))
+        if src_suffix == 'rgba_float' and is_unorm8x4_format(format):
+            print('      x = 0;')
+            generate_unorm8x4_pack_float_sse2(format)
+            print('      for(; x < width; x += 1) {')
+        elif src_suffix == 'rgba_float' and is_unorm32_format(format):
+            print('      x = 0;')
+            generate_unorm32_pack_float_sse2(format)
+            print('      for(; x < width; x += 1) {')
+        else:
+            print('      for(x = 0; x < width; x += %u) {' % (format.block_width,))
     
         generate_pack_kernel(format, src_channel, src_native_type)
             
@@ -714,6 +908,9 @@ def is_format_hand_written(format):
 def generate(formats):
     print()
     print('#include "pipe/p_compiler.h"')
+    print('#if defined(PIPE_ARCH_SSE)')
+    print('#include <emmintrin.h>')
+    print('#endif')
     print('#include "util/u_math.h"')
     print('#include "util/half_float.h"')
     print('#include "u_format.h"')
@@ -120,15 +120,11 @@ struct ra_class {
 };
 
 struct ra_node {
-   /** @{
-    *
+   /**
     * List of which nodes this node interferes with.  This should be
     * symmetric with the other node.
     */
-   BITSET_WORD *adjacency;
-
    struct util_dynarray adjacency_list;
-   /** @} */
 
    unsigned int class;
 
@@ -165,6 +161,15 @@ struct ra_graph {
     * the variables that need register allocation.
     */
    struct ra_node *nodes;
+
+   /**
+    * Lower-triangular interference bitset, used to quickly check whether
+    * two nodes are already known to interfere.  The bit for the pair
+    * (n1, n2) with n1 < n2 is at n2 * (n2 - 1) / 2 + n1, so each node's row
+    * is stored after all the rows of the nodes before it and growing the
+    * graph only appends to the bitset.
+    */
+   BITSET_WORD *adjacency;
    unsigned int count; /**< count of nodes. */
 
    unsigned int alloc; /**< count of nodes allocated. */
@@ -484,11 +489,44 @@ ra_set_deserialize(void *mem_ctx, struct blob_reader *blob)
    return regs;
 }
 
+static uint64_t
+ra_get_num_adjacency_bits(uint64_t n)
+{
+   return (n * (n - 1)) / 2;
+}
+
+static uint64_t
+ra_get_adjacency_bit_index(unsigned int n1, unsigned int n2)
+{
+   assert(n1 != n2);
+   unsigned int lo = MIN2(n1, n2), hi = MAX2(n1, n2);
+   return ra_get_num_adjacency_bits(hi) + lo;
+}
+
+static bool
+ra_test_adjacency(struct ra_graph *g, unsigned int n1, unsigned int n2)
+{
+   uint64_t index = ra_get_adjacency_bit_index(n1, n2);
+   return BITSET_TEST(g->adjacency, index);
+}
+
 static void
-ra_add_node_adjacency(struct ra_graph *g, unsigned int n1, unsigned int n2)
+ra_set_adjacency(struct ra_graph *g, unsigned int n1, unsigned int n2)
+{
+   uint64_t index = ra_get_adjacency_bit_index(n1, n2);
+   BITSET_SET(g->adjacency, index);
+}
+
+static void
+ra_clear_adjacency(struct ra_graph *g, unsigned int n1, unsigned int n2)
 {
-   BITSET_SET(g->nodes[n1].adjacency, n2);
+   uint64_t index = ra_get_adjacency_bit_index(n1, n2);
+   BITSET_CLEAR(g->adjacency, index);
+}
 
+static void
+ra_add_node_adjacency(struct ra_graph *g, unsigned int n1, unsigned int n2)
+{
    assert(n1 != n2);
 
    int n1_class = g->nodes[n1].class;
@@ -501,8 +539,6 @@ ra_add_node_adjacency(struct ra_graph *g, unsigned int n1, unsigned int n2)
 static void
 ra_node_remove_adjacency(struct ra_graph *g, unsigned int n1, unsigned int n2)
 {
-   BITSET_CLEAR(g->nodes[n1].adjacency, n2);
-
    assert(n1 != n2);
 
    int n1_class = g->nodes[n1].class;
@@ -527,19 +563,21 @@ ra_realloc_interference_graph(struct ra_graph *g, unsigned int alloc)
 
    g->nodes = reralloc(g, g->nodes, struct ra_node, alloc);
 
-   unsigned g_bitset_count = BITSET_WORDS(g->alloc);
+   /* The rows of the existing nodes don't move when the triangular
+    * adjacency bitset grows, so we only have to zero the new tail.
+    */
+   size_t g_adjacency_size =
+      BITSET_WORDS(ra_get_num_adjacency_bits(g->alloc)) * sizeof(BITSET_WORD);
+   size_t adjacency_size =
+      BITSET_WORDS(ra_get_num_adjacency_bits(alloc)) * sizeof(BITSET_WORD);
+   g->adjacency = rerzalloc_size(g, g->adjacency,
+                                 g_adjacency_size, adjacency_size);
+
    unsigned bitset_count = BITSET_WORDS(alloc);
-   /* For nodes already in the graph, we just have to grow the adjacency set */
-   for (unsigned i = 0; i < g->alloc; i++) {
-      assert(g->nodes[i].adjacency != NULL);
-      g->nodes[i].adjacency = rerzalloc(g, g->nodes[i].adjacency, BITSET_WORD,
-                                        g_bitset_count, bitset_count);
-   }
 
    /* For new nodes, we have to fully initialize them */
    for (unsigned i = g->alloc; i < alloc; i++) {
       memset(&g->nodes[i], 0, sizeof(g->nodes[i]));
-      g->nodes[i].adjacency = rzalloc_array(g, BITSET_WORD, bitset_count);
       util_dynarray_init(&g->nodes[i].adjacency_list, g);
       g->nodes[i].q_total = 0;
 
@@ -623,7 +661,8 @@ ra_add_node_interference(struct ra_graph *g,
                          unsigned int n1, unsigned int n2)
 {
    assert(n1 < g->count && n2 < g->count);
-   if (n1 != n2 && !BITSET_TEST(g->nodes[n1].adjacency, n2)) {
+   if (n1 != n2 && !ra_test_adjacency(g, n1, n2)) {
+      ra_set_adjacency(g, n1, n2);
       ra_add_node_adjacency(g, n1, n2);
       ra_add_node_adjacency(g, n2, n1);
    }
@@ -633,11 +672,10 @@ void
 ra_reset_node_interference(struct ra_graph *g, unsigned int n)
 {
    util_dynarray_foreach(&g->nodes[n].adjacency_list, unsigned int, n2p) {
+      ra_clear_adjacency(g, n, *n2p);
       ra_node_remove_adjacency(g, *n2p, n);
    }
 
-   memset(g->nodes[n].adjacency, 0,
-          BITSET_WORDS(g->count) * sizeof(BITSET_WORD));
    util_dynarray_clear(&g->nodes[n].adjacency_list);
 }
 
@@ -0,0 +1,153 @@
+/*
+ * Copyright © 2020 The Mesa Authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/*
+ * Throughput benchmark for the row pack/unpack functions of the common
+ * color formats.  Not run as part of the test suite; run it by hand and
+ * compare the MPix/s numbers before and after changing u_format_pack.py.
+ *
+ * Usage: u_format_bench [width] [height] [iterations]
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "util/os_time.h"
+#include "util/u_cpu_detect.h"
+#include "util/format/u_format.h"
+
+static const enum pipe_format bench_formats[] = {
+   PIPE_FORMAT_R8G8B8A8_UNORM,
+   PIPE_FORMAT_B8G8R8A8_UNORM,
+   PIPE_FORMAT_R8G8B8A8_SRGB,
+   PIPE_FORMAT_R10G10B10A2_UNORM,
+   PIPE_FORMAT_B5G6R5_UNORM,
+   PIPE_FORMAT_R16_FLOAT,
+   PIPE_FORMAT_R16G16B16A16_FLOAT,
+   PIPE_FORMAT_R11G11B10_FLOAT,
+   PIPE_FORMAT_R32G32B32A32_FLOAT,
+};
+
+static double
+mpix_per_sec(int64_t ns, unsigned pixels, unsigned iterations)
+{
+   if (ns <= 0)
+      return 0.0;
+
+   return (double)pixels * iterations / (ns / 1000.0);
+}
+
+int
+main(int argc, char **argv)
+{
+   unsigned width = argc > 1 ? atoi(argv[1]) : 1024;
+   unsigned height = argc > 2 ? atoi(argv[2]) : 1024;
+   unsigned iterations = argc > 3 ? atoi(argv[3]) : 10;
+   unsigned pixels = width * height;
+
+   if (!width || !height || !iterations) {
+      fprintf(stderr, "usage: %s [width] [height] [iterations]\n", argv[0]);
+      return 1;
+   }
+
+   uint8_t *packed = malloc(pixels * 16);
+   float *rgba_float = malloc(pixels * 4 * sizeof(float));
+   uint8_t *rgba_8unorm = malloc(pixels * 4);
+   if (!packed || !rgba_float || !rgba_8unorm) {
+      fprintf(stderr, "out of memory\n");
+      return 1;
+   }
+
+   util_cpu_detect();
+
+   srand(0);
+   for (unsigned i = 0; i < pixels * 4; i++) {
+      rgba_float[i] = (float)rand() / RAND_MAX;
+      rgba_8unorm[i] = rand();
+   }
+
+   printf("%ux%u, %u iterations, MPix/s\n", width, height, iterations);
+   printf("%-32s %12s %12s %12s %12s\n", "format",
+          "unpack f32", "pack f32", "unpack 8", "pack 8");
+
+   for (unsigned f = 0; f < ARRAY_SIZE(bench_formats); f++) {
+      enum pipe_format format = bench_formats[f];
+      const struct util_format_description *desc =
+         util_format_description(format);
+      const struct util_format_unpack_description *unpack =
+         util_format_unpack_description(format);
+      const struct util_format_pack_description *pack =
+         util_format_pack_description(format);
+      unsigned stride = width * desc->block.bits / 8;
+      int64_t start;
+
+      /* Start from sensible values rather than random bits, which would
+       * be full of NaNs and denormals for the float formats.
+       */
+      pack->pack_rgba_float(packed, stride,
+                            rgba_float, width * 4 * sizeof(float),
+                            width, height);
+
+      start = os_time_get_nano();
+      for (unsigned i = 0; i < iterations; i++) {
+         unpack->unpack_rgba(rgba_float, width * 4 * sizeof(float),
+                             packed, stride, width, height);
+      }
+      double unpack_float = mpix_per_sec(os_time_get_nano() - start,
+                                         pixels, iterations);
+
+      start = os_time_get_nano();
+      for (unsigned i = 0; i < iterations; i++) {
+         pack->pack_rgba_float(packed, stride,
+                               rgba_float, width * 4 * sizeof(float),
+                               width, height);
+      }
+      double pack_float = mpix_per_sec(os_time_get_nano() - start,
+                                       pixels, iterations);
+
+      start = os_time_get_nano();
+      for (unsigned i = 0; i < iterations; i++) {
+         unpack->unpack_rgba_8unorm(rgba_8unorm, width * 4,
+                                    packed, stride, width, height);
+      }
+      double unpack_8unorm = mpix_per_sec(os_time_get_nano() - start,
+                                          pixels, iterations);
+
+      start = os_time_get_nano();
+      for (unsigned i = 0; i < iterations; i++) {
+         pack->pack_rgba_8unorm(packed, stride, rgba_8unorm, width * 4,
+                                width, height);
+      }
+      double pack_8unorm = mpix_per_sec(os_time_get_nano() - start,
+                                        pixels, iterations);
+
+      printf("%-32s %12.1f %12.1f %12.1f %12.1f\n", desc->short_name,
+             unpack_float, pack_float, unpack_8unorm, pack_8unorm);
+   }
+
+   free(packed);
+   free(rgba_float);
+   free(rgba_8unorm);
+
+   return 0;
+}
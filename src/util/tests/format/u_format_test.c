@@ -28,6 +28,7 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <float.h>
 
 #include "util/half_float.h"
@@ -846,11 +847,100 @@ test_all(void)
 }
 
 
+/* Four 8-bit UNORM or padding channels in a 32-bit word. */
+static boolean
+is_unorm8888(const struct util_format_description *desc)
+{
+   if (desc->layout != UTIL_FORMAT_LAYOUT_PLAIN ||
+       !desc->is_bitmask ||
+       desc->block.bits != 32 ||
+       desc->nr_channels != 4)
+      return FALSE;
+
+   for (unsigned i = 0; i < 4; i++) {
+      if (desc->channel[i].size != 8)
+         return FALSE;
+      if (desc->channel[i].type != UTIL_FORMAT_TYPE_VOID &&
+          (desc->channel[i].type != UTIL_FORMAT_TYPE_UNSIGNED ||
+           !desc->channel[i].normalized))
+         return FALSE;
+   }
+
+   return TRUE;
+}
+
+
+/*
+ * util_format_translate() converts pairs of 8-bit RGBA-style formats
+ * directly.  Check that it gives the same bytes as unpacking to float and
+ * packing again, including for sRGB pairs.
+ */
+static boolean
+test_translate_unorm8888(void)
+{
+   const unsigned width = 37, height = 3;
+   const unsigned stride = width * 4;
+   uint8_t src[3 * 37 * 4], dst[3 * 37 * 4], ref[3 * 37 * 4];
+   float rgba[37][4];
+   enum pipe_format src_format, dst_format;
+   boolean success = TRUE;
+
+   printf("Testing util_format_translate for 8-bit RGBA formats ...\n");
+   fflush(stdout);
+
+   srand(0);
+   for (unsigned i = 0; i < sizeof(src); i++)
+      src[i] = rand();
+
+   for (src_format = 1; src_format < PIPE_FORMAT_COUNT; ++src_format) {
+      const struct util_format_description *src_desc =
+         util_format_description(src_format);
+
+      if (!src_desc || !is_unorm8888(src_desc))
+         continue;
+
+      for (dst_format = 1; dst_format < PIPE_FORMAT_COUNT; ++dst_format) {
+         const struct util_format_description *dst_desc =
+            util_format_description(dst_format);
+
+         /* Compatible formats are copied as-is, padding included. */
+         if (!dst_desc || !is_unorm8888(dst_desc) ||
+             dst_desc->colorspace != src_desc->colorspace ||
+             util_is_format_compatible(src_desc, dst_desc))
+            continue;
+
+         for (unsigned y = 0; y < height; y++) {
+            util_format_unpack_rgba(src_format, rgba, src + y * stride,
+                                    width);
+            util_format_pack_rgba(dst_format, ref + y * stride, rgba,
+                                  width);
+         }
+
+         memset(dst, 0, sizeof(dst));
+         util_format_translate(dst_format, dst, stride, 0, 0,
+                               src_format, src, stride, 0, 0,
+                               width, height);
+
+         if (memcmp(dst, ref, sizeof(dst)) != 0) {
+            printf("FAILED: %s -> %s\n",
+                   src_desc->short_name, dst_desc->short_name);
+            success = FALSE;
+         }
+      }
+   }
+
+   return success;
+}
+
+
 int main(int argc, char **argv)
 {
    boolean success;
 
    success = test_all();
 
+   if (!test_translate_unorm8888())
+      success = FALSE;
+
    return success ? 0 : 1;
 }